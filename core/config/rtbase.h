@@ -583,6 +583,19 @@ typedef rt_ui64             rt_uadr;
 
 #endif /* RT_ADDRESS */
 
+/* top of in-heap address range in 64/32-bit hybrid mode (RT_ADDRESS < P),
+ * a64 and x64 zero the upper half in 32-bit ops allowing the whole 4GB range,
+ * while m64 sign-extends and p64 overflows, thus limiting it to lower 2GB */
+#if   (defined RT_A64) || (defined RT_X64)
+
+#define RT_ADDRESS_TOP      ((rt_full)0x0000000100000000)
+
+#else  /* RT_A64, RT_X64 */
+
+#define RT_ADDRESS_TOP      ((rt_full)0x0000000080000000)
+
+#endif /* RT_A64, RT_X64 */
+
 /* pointer-size integer types */
 #if   (defined RT_WIN64) /* Win64, GCC -------------------------------------- */
 
@@ -6,6 +6,16 @@
 
 #include <string.h>
 
+/* system headers go first, RT_PROFILE
+ * is expected to come from build flags */
+#if RT_PROFILE != 0
+#if   (defined RT_WIN32) || (defined RT_WIN64)
+#include <windows.h>
+#else /* Linux, GCC */
+#include <time.h>
+#endif /* OS specific */
+#endif /* RT_PROFILE */
+
 #include "engine.h"
 #include "rtimag.h"
 
@@ -181,7 +191,7 @@ rt_void print_lgt(rt_pstr mgn, rt_ELEM *elm, rt_Object *obj)
 static
 rt_pstr tags[RT_TAG_SURFACE_MAX] =
 {
-    "PL", "CL", "SP", "CN", "PB", "HB", "PC", "HC", "HP"
+    "PL", "CL", "SP", "CN", "PB", "HB", "PC", "HC", "HP", "MS"
 };
 
 static
@@ -416,6 +426,34 @@ rt_void print_lst(rt_pstr mgn, rt_ELEM *elm)
         RT_LOGI("*********************************************");           \
         RT_LOGI("\n")
 
+/******************************************************************************/
+/********************************   PROFILING   *******************************/
+/******************************************************************************/
+
+#if RT_PROFILE != 0
+
+/*
+ * Get monotonic time in microseconds for profiling.
+ */
+static
+rt_time get_usec()
+{
+#if   (defined RT_WIN32) || (defined RT_WIN64)
+    LARGE_INTEGER fr;
+    QueryPerformanceFrequency(&fr);
+    LARGE_INTEGER tm;
+    QueryPerformanceCounter(&tm);
+    return (rt_time)(tm.QuadPart / fr.QuadPart) * 1000000 +
+           (rt_time)(tm.QuadPart % fr.QuadPart) * 1000000 / fr.QuadPart;
+#else /* Linux, GCC */
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return (rt_time)tm.tv_sec * 1000000 + tm.tv_nsec / 1000;
+#endif /* OS specific */
+}
+
+#endif /* RT_PROFILE */
+
 /******************************************************************************/
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
@@ -572,6 +610,7 @@ rt_Platform::rt_Platform(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free,
     /* init rendering backend,
      * default SIMD runtime target will be chosen */
     fsaa = RT_FSAA_NO;
+    pack = RT_PACK_NO;
     set_simd(0);
 }
 
@@ -679,6 +718,29 @@ rt_si32 rt_Platform::get_fsaa()
     return fsaa;
 }
 
+/*
+ * Set current SIMD packing mode.
+ */
+rt_si32 rt_Platform::set_pack(rt_si32 pack)
+{
+    if (pack != RT_PACK_2D)
+    {
+        pack = RT_PACK_NO;
+    }
+
+    this->pack = pack;
+
+    return pack;
+}
+
+/*
+ * Get current SIMD packing mode.
+ */
+rt_si32 rt_Platform::get_pack()
+{
+    return pack;
+}
+
 /*
  * Get maximmum antialiasing mode
  * for chosen SIMD target.
@@ -842,6 +904,8 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     this->scene = scene;
     this->index = index;
 
+    set_huge(scene->get_huge());
+
     /* allocate root SIMD structure */
     s_inf = (rt_SIMD_INFOX *)
             alloc(sizeof(rt_SIMD_INFOX),
@@ -874,6 +938,11 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     s_inf->ptr_b   = scene->ptr_b;
     s_inf->pt_on   = scene->pt_on;
 
+    /* allocate cache of last occluders per shadow list */
+    s_inf->occ = alloc(sizeof(rt_ELEM) * RT_OCC_SLOTS, RT_ALIGN);
+
+    memset(s_inf->occ, 0, sizeof(rt_ELEM) * RT_OCC_SLOTS);
+
 #if   RT_PRNG == LCG16
 
     /* init PRNG's constants (32-bit LCG) */
@@ -948,6 +1017,20 @@ rt_SceneThread::rt_SceneThread(rt_Scene *scene, rt_si32 index) :
     /* estimates are done in Scene once all counters have been initialized */
     msize = 0;
 
+    /* init memory pool checkpoint for camera-dependent allocs */
+    cpool = RT_NULL;
+
+    /* init empty queue of tile-row jobs */
+    jhead = 0;
+    jtail = 0;
+
+#if RT_PROFILE != 0
+    /* init profiling timestamps */
+    memset(p_beg, 0, sizeof(p_beg));
+    memset(p_end, 0, sizeof(p_end));
+    p_tls = 0;
+#endif /* RT_PROFILE */
+
     /* allocate misc arrays for tiling */
     txmin = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
     txmax = (rt_si32 *)alloc(sizeof(rt_si32) * scene->tiles_in_col, RT_ALIGN);
@@ -1764,241 +1847,801 @@ rt_ELEM* rt_SceneThread::filter(rt_Object *obj, rt_ELEM **ptr)
 }
 
 /*
- * Build trnode/bvnode list for a given surface "srf"
- * after all transform flags have been set in "update_fields",
- * thus trnode elements are handled properly.
+ * Get surface's leaf index in scene's bvh from list element "e".
  */
-rt_void rt_SceneThread::snode(rt_Surface *srf)
-{
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+#define RT_GET_BVI(e)                                                       \
+        (((rt_Surface *)((rt_BOUND *)(e)->temp)->obj)->bvi)
 
-    /* reset surface's trnode/bvnode list */
-    srf->top = RT_NULL;
-    srf->trn = RT_NULL;
+/*
+ * Compute half of the bbox's surface area for SAH.
+ */
+static
+rt_real bbox_area(rt_vec4 bmin, rt_vec4 bmax)
+{
+    rt_vec4 dff;
+    RT_VEC3_SUB(dff, bmax, bmin);
 
-    /* build surface's trnode/bvnode list,
-     * trnode hierarchy is flat as objects with
-     * non-trivial transform are their own trnodes,
-     * while bvnodes can have arbitrary depth
-     * above and below the trnode (if present) */
-    rt_ELEM *elm;
-    rt_Object *par;
+    return dff[RT_X] * dff[RT_Y] +
+           dff[RT_Y] * dff[RT_Z] +
+           dff[RT_Z] * dff[RT_X];
+}
 
-    /* phase 1, bvnodes (if any) below trnode (if any),
-     * if the same array serves as both trnode and bvnode,
-     * trnode is considered above only if bvnode is split,
-     * thus bvnode is inserted first in this case */
-    for (par = srf->bvnode; srf->trnode != RT_NULL && par != RT_NULL &&
-         par->trnode == srf->trnode && (par->trnode != par ||
-         ((rt_Array *)par)->trbox->rad != 0.0f);
-         par = par->bvnode)
+/*
+ * Sort NULL-terminated list "lst" of "num" surface elements
+ * in scene's bvh leaf order (recursive merge sort, stable).
+ * Return new head of the list.
+ */
+static
+rt_ELEM* bvsort(rt_ELEM *lst, rt_si32 num)
+{
+    if (num <= 1)
     {
-        rt_Array *arr = (rt_Array *)par;
-
-        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-        elm->data = 0;
-        elm->simd = (rt_pntr)1; /* node's type (bv) */
-        elm->temp = arr->inbox;
-        elm->next = srf->top;
-        srf->top = elm;
+        return lst;
     }
 
-    /* phase 2, there can only be one trnode (if any),
-     * even though there might be other trnodes
-     * above and below in the object hierarchy
-     * they themselves don't form the hierarchy
-     * as any trnode is always its own trnode */
-    if (srf->trnode != RT_NULL && srf->trnode != srf)
+    rt_si32 i, n = num / 2;
+    rt_ELEM *lft = lst, *rgt = lst, *prv = RT_NULL;
+
+    for (i = 0; i < n; i++)
     {
-        rt_Array *arr = (rt_Array *)srf->trnode;
+        prv = rgt;
+        rgt = rgt->next;
+    }
 
-        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-        elm->data = 0;
-        elm->simd = (rt_pntr)0; /* node's type (tr) */
-        elm->temp = arr->trbox->rad != 0.0f ? arr->trbox : arr->inbox;
-        elm->next = srf->top;
-        srf->top = elm;
+    prv->next = RT_NULL;
 
-        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-        elm->data = 0;
-        elm->simd = (rt_pntr)0; /* node's type (tr) */
-        elm->temp = srf->top->temp;
-        elm->next = RT_NULL;
-        srf->trn = elm;
-    }
+    lft = bvsort(lft, n);
+    rgt = bvsort(rgt, num - n);
 
-    /* phase 3, bvnodes (if any) above trnode (if any) */
-    for (; par != RT_NULL; par = par->bvnode)
-    {
-        rt_Array *arr = (rt_Array *)par;
+    rt_ELEM **ptr = &lst;
 
-        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-        elm->data = 0;
-        elm->simd = (rt_pntr)1; /* node's type (bv) */
-        elm->temp = arr->bvbox->rad != 0.0f ? arr->bvbox : arr->inbox;
-        elm->next = srf->top;
-        srf->top = elm;
+    while (lft != RT_NULL && rgt != RT_NULL)
+    {
+        if (RT_GET_BVI(lft) <= RT_GET_BVI(rgt))
+        {
+           *ptr = lft;
+            ptr = &lft->next;
+            lft = lft->next;
+        }
+        else
+        {
+           *ptr = rgt;
+            ptr = &rgt->next;
+            rgt = rgt->next;
+        }
     }
+
+   *ptr = lft != RT_NULL ? lft : rgt;
+
+    return lst;
 }
 
 /*
- * Build custom clippers list from "srf" relations template
- * after all transform flags have been set in "update_fields",
- * thus trnode elements are handled properly.
+ * Build scene's bounding volume hierarchy over surfaces with finite bounds
+ * using surface area heuristic (SAH) on their world space bboxes.
+ * Surfaces are numbered in bvh leaf order used by "bvtree".
+ * Return root node of the hierarchy or NULL if less than two surfaces.
  */
-rt_void rt_SceneThread::sclip(rt_Surface *srf)
+rt_BVNODE* rt_SceneThread::bvbuild()
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
-
-    /* init surface's relations template */
-    rt_ELEM *lst = srf->rel;
+    /* the bvh is built from scratch whenever lists are rebuilt,
+     * even if few surfaces moved, no incremental refit is done,
+     * as refitted nodes degrade with motion and leaf order would
+     * go out of sync with surface numbers used by "bvtree" */
 
-    /* init and reset custom clippers list */
-    rt_ELEM **ptr = RT_GET_ADR(srf->s_srf->msc_p[2]);
-   *ptr = RT_NULL;
+    rt_Surface *srf;
+    rt_si32 i, k, n = 0;
 
-    /* build custom clippers list from given template "lst",
-     * as given template "lst" is inverted in surface's "add_relation"
-     * and elements are inserted into the list's head here,
-     * the original relations template from scene data is inverted twice,
-     * thus accum enter/leave markers will end up in correct order */
-    for (; lst != RT_NULL; lst = lst->next)
+    for (srf = scene->srf_head; srf != RT_NULL; srf = srf->next)
     {
-        rt_ELEM *elm;
-        rt_cell rel = lst->data;
-        rt_Object *obj = lst->temp == RT_NULL ? RT_NULL :
-                         (rt_Object *)((rt_BOUND *)lst->temp)->obj;
+        rt_BOUND *box = srf->bvbox;
 
-        if (obj == RT_NULL)
+        srf->bvi = -1;
+
+        if (box->rad != 0.0f && box->rad != RT_INF && box->verts_num > 0)
         {
-            /* alloc new element for accum marker */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = rel;
-            elm->simd = RT_NULL; /* accum marker */
-            elm->temp = RT_NULL;
-            /* insert element as list's head */
-            elm->next = *ptr;
-           *ptr = elm;
+            n++;
         }
-        else
-        if (RT_IS_SURFACE(obj))
-        {
-            rt_Surface *srf = (rt_Surface *)obj;
+    }
 
-            /* alloc new element for "srf" */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = rel;
-            elm->simd = srf->s_srf;
-            elm->temp = srf->bvbox;
+    if (n < 2)
+    {
+        return RT_NULL;
+    }
 
-            if (srf->trnode != RT_NULL && srf->trnode != srf)
-            {
-                rt_si32 acc = 0;
-                rt_ELEM *nxt;
+    rt_BVNODE *lfn = (rt_BVNODE *)alloc(sizeof(rt_BVNODE) * n, RT_QUAD_ALIGN);
+    rt_BVNODE **lfs = (rt_BVNODE **)alloc(sizeof(rt_BVNODE *) * n,
+                                                            RT_QUAD_ALIGN);
 
-                rt_Array *arr = (rt_Array *)srf->trnode;
-                rt_BOUND *trb = arr->trbox; /* not used for clippers */
+    /* init leaves with surfaces' bboxes computed
+     * from bvbox verts, which are always in world space */
+    for (srf = scene->srf_head, i = 0; srf != RT_NULL; srf = srf->next)
+    {
+        rt_BOUND *box = srf->bvbox;
 
-                /* search matching existing trnode for insertion
-                 * either within current accum segment
-                 * or outside of any accum segment */
-                for (nxt = *ptr; nxt != RT_NULL; nxt = nxt->next)
-                {
-                    /* "acc == 0" either accum-enter-marker
-                     * hasn't been inserted yet (current accum segment)
-                     * or outside of any accum segment */
-                    if (acc == 0
-                    &&  nxt->temp == trb)
-                    {
-                        break;
-                    }
+        if (box->rad == 0.0f || box->rad == RT_INF || box->verts_num == 0)
+        {
+            continue;
+        }
 
-                    /* skip all non-accum-marker elements */
-                    if (nxt->temp != RT_NULL)
-                    {
-                        continue;
-                    }
+        rt_BVNODE *nd = &lfn[i];
 
-                    /* didn't find trnode within current accum segment,
-                     * leaving cycle, new trnode element will be inserted */
-                    if (acc == 0
-                    &&  nxt->data == RT_ACCUM_LEAVE)
-                    {
-                        nxt = RT_NULL;
-                        break;
-                    }
+        RT_VEC3_SET(nd->bmin, box->verts[0].pos);
+        RT_VEC3_SET(nd->bmax, box->verts[0].pos);
 
-                    /* skip accum segment different from the one
-                     * current element is being inserted into */
-                    if (acc == 0
-                    &&  nxt->data == RT_ACCUM_ENTER)
-                    {
-                        acc = 1;
-                    }
+        for (k = 1; k < box->verts_num; k++)
+        {
+            RT_VEC3_MIN(nd->bmin, nd->bmin, box->verts[k].pos);
+            RT_VEC3_MAX(nd->bmax, nd->bmax, box->verts[k].pos);
+        }
 
-                    /* keep track of accum segments */
-                    if (acc == 1
-                    &&  nxt->data == RT_ACCUM_LEAVE)
-                    {
-                        acc = 0;
-                    }
-                }
+        nd->sub[0] = RT_NULL;
+        nd->sub[1] = RT_NULL;
+        nd->srf = srf;
+        nd->box = RT_NULL;
+        nd->s_srf = RT_NULL;
 
-                if (nxt == RT_NULL)
-                {
-                    /* insert element as list's head */
-                    elm->next = *ptr;
-                   *ptr = elm;
+        lfs[i++] = nd;
+    }
 
-                    /* alloc new trnode element as none has been found */
-                    nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-                    nxt->data = (rt_cell)elm; /* trnode's last element */
-                    nxt->simd = arr->s_srf;
-                    nxt->temp = trb;
-                    /* insert element as list's head */
-                    nxt->next = *ptr;
-                   *ptr = nxt;
-                }
-                else
-                {
-                    /* insert element under existing trnode */
-                    elm->next = nxt->next;
-                    nxt->next = elm;
-                }
-            }
-            else
-            {
-                /* insert element as list's head */
-                elm->next = *ptr;
-               *ptr = elm;
-            }
-        }
+    rt_BVNODE *top = bvsplit(lfs, 0, n);
+
+    /* number surfaces in bvh leaf order */
+    for (i = 0; i < n; i++)
+    {
+        lfs[i]->lft = i;
+        lfs[i]->mdl = i + 1;
+        lfs[i]->rgt = i + 1;
+        lfs[i]->srf->bvi = i;
     }
+
+    return top;
 }
 
 /*
- * Build tile list for a given surface "srf" based
- * on the area its projected bbox occupies in the tilebuffer.
+ * Build bvh node for leaves [lft, rgt) of "lfs" by splitting them
+ * at binned SAH minimum along the largest axis of leaves' centers,
+ * leaves are reordered in place to become contiguous in each subnode.
+ * Return node or leaf itself if the range has only one leaf (recursive).
  */
-rt_void rt_SceneThread::stile(rt_Surface *srf)
+rt_BVNODE* rt_SceneThread::bvsplit(rt_BVNODE **lfs, rt_si32 lft, rt_si32 rgt)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
-
-    srf->tls = RT_NULL;
-
-#if RT_OPTS_TILING != 0
-    if ((scene->opts & RT_OPTS_TILING) == 0)
-#endif /* RT_OPTS_TILING */
+    if (rgt - lft == 1)
     {
-        return;
+        return lfs[lft];
     }
 
-    rt_ELEM *elm;
-    rt_si32 i, j;
-    rt_si32 k;
+    rt_si32 i, j, k, n;
+    rt_vec4 cmin, cmax, cnt;
+
+    rt_BVNODE *nd = (rt_BVNODE *)alloc(sizeof(rt_BVNODE), RT_QUAD_ALIGN);
+
+    RT_VEC3_SET(nd->bmin, lfs[lft]->bmin);
+    RT_VEC3_SET(nd->bmax, lfs[lft]->bmax);
+
+    RT_VEC3_ADD(cmin, lfs[lft]->bmin, lfs[lft]->bmax);
+    RT_VEC3_SET(cmax, cmin);
+
+    for (i = lft + 1; i < rgt; i++)
+    {
+        RT_VEC3_MIN(nd->bmin, nd->bmin, lfs[i]->bmin);
+        RT_VEC3_MAX(nd->bmax, nd->bmax, lfs[i]->bmax);
+
+        /* doubled leaf's center */
+        RT_VEC3_ADD(cnt, lfs[i]->bmin, lfs[i]->bmax);
+        RT_VEC3_MIN(cmin, cmin, cnt);
+        RT_VEC3_MAX(cmax, cmax, cnt);
+    }
+
+    /* select the largest axis of leaves' centers */
+    RT_VEC3_SUB(cnt, cmax, cmin);
+    k = cnt[RT_X] >= cnt[RT_Y] ? RT_X : RT_Y;
+    k = cnt[RT_Z] > cnt[k] ? RT_Z : k;
+
+    /* split in the middle if all centers coincide or SAH fails */
+    n = (lft + rgt) / 2;
+
+    if (cnt[k] > 0.0f)
+    {
+        rt_si32 bnum[RT_BVH_BINS], rnum[RT_BVH_BINS], b = 0, m = 0;
+        rt_vec4 bmin[RT_BVH_BINS], bmax[RT_BVH_BINS], vmin, vmax;
+        rt_real rarea[RT_BVH_BINS], cost = RT_INF;
+        rt_real f = (rt_real)RT_BVH_BINS / cnt[k];
+
+        memset(bnum, 0, sizeof(bnum));
+
+        /* distribute leaves into bins by their centers */
+        for (i = lft; i < rgt; i++)
+        {
+            j = (rt_si32)((lfs[i]->bmin[k] + lfs[i]->bmax[k] - cmin[k]) * f);
+            j = RT_MIN(j, RT_BVH_BINS - 1);
+
+            if (bnum[j]++ == 0)
+            {
+                RT_VEC3_SET(bmin[j], lfs[i]->bmin);
+                RT_VEC3_SET(bmax[j], lfs[i]->bmax);
+            }
+            else
+            {
+                RT_VEC3_MIN(bmin[j], bmin[j], lfs[i]->bmin);
+                RT_VEC3_MAX(bmax[j], bmax[j], lfs[i]->bmax);
+            }
+        }
+
+        /* sweep bins from the right to accumulate areas */
+        for (j = RT_BVH_BINS - 1, m = 0; j > 0; j--)
+        {
+            if (bnum[j] != 0)
+            {
+                if (m == 0)
+                {
+                    RT_VEC3_SET(vmin, bmin[j]);
+                    RT_VEC3_SET(vmax, bmax[j]);
+                }
+                else
+                {
+                    RT_VEC3_MIN(vmin, vmin, bmin[j]);
+                    RT_VEC3_MAX(vmax, vmax, bmax[j]);
+                }
+                m += bnum[j];
+            }
+
+            rnum[j] = m;
+            rarea[j] = m != 0 ? bbox_area(vmin, vmax) : 0.0f;
+        }
+
+        /* sweep bins from the left to find SAH minimum */
+        for (j = 1, m = 0; j < RT_BVH_BINS; j++)
+        {
+            if (bnum[j - 1] != 0)
+            {
+                if (m == 0)
+                {
+                    RT_VEC3_SET(vmin, bmin[j - 1]);
+                    RT_VEC3_SET(vmax, bmax[j - 1]);
+                }
+                else
+                {
+                    RT_VEC3_MIN(vmin, vmin, bmin[j - 1]);
+                    RT_VEC3_MAX(vmax, vmax, bmax[j - 1]);
+                }
+                m += bnum[j - 1];
+            }
+
+            if (m == 0 || rnum[j] == 0)
+            {
+                continue;
+            }
+
+            rt_real c = bbox_area(vmin, vmax) * m + rarea[j] * rnum[j];
+
+            if (cost > c)
+            {
+                cost = c;
+                b = j;
+            }
+        }
+
+        /* partition leaves by the selected bin */
+        if (b > 0)
+        {
+            for (i = lft, j = rgt - 1; i <= j;)
+            {
+                m = (rt_si32)((lfs[i]->bmin[k] + lfs[i]->bmax[k] - cmin[k]) * f);
+                m = RT_MIN(m, RT_BVH_BINS - 1);
+
+                if (m < b)
+                {
+                    i++;
+                }
+                else
+                {
+                    rt_BVNODE *tmp = lfs[i];
+                    lfs[i] = lfs[j];
+                    lfs[j--] = tmp;
+                }
+            }
+
+            n = i;
+        }
+    }
+
+    nd->lft = lft;
+    nd->mdl = n;
+    nd->rgt = rgt;
+
+    nd->sub[0] = bvsplit(lfs, lft, n);
+    nd->sub[1] = bvsplit(lfs, n, rgt);
+
+    nd->srf = RT_NULL;
+
+    /* node's bounding volume mimics array's bvbox,
+     * root array serves as its host object in lists */
+    rt_BOUND *box = (rt_BOUND *)alloc(sizeof(rt_BOUND), RT_QUAD_ALIGN);
+    memset(box, 0, sizeof(rt_BOUND));
+
+    box->obj = scene->root;
+    box->tag = RT_TAG_ARRAY;
+
+    RT_VEC3_SET(box->bmin, nd->bmin);
+    RT_VEC3_SET(box->bmax, nd->bmax);
+
+    RT_VEC3_ADD(box->mid, nd->bmin, nd->bmax);
+    RT_VEC3_MUL_VAL1(box->mid, box->mid, 0.5f);
+
+    rt_vec4 dff;
+    RT_VEC3_SUB(dff, nd->bmax, box->mid);
+    box->rad = RT_VEC3_LEN(dff);
+
+    nd->box = box;
+
+    rt_SIMD_SURFACE *s_srf = (rt_SIMD_SURFACE *)
+                             alloc(sizeof(rt_SIMD_SURFACE), RT_SIMD_ALIGN);
+    memset(s_srf, 0, sizeof(rt_SIMD_SURFACE));
+    s_srf->srf_t[3] = RT_TAG_SURFACE_MAX;
+
+    s_srf->a_map[RT_I] = RT_X * RT_SIMD_QUADS * 16;
+    s_srf->a_map[RT_J] = RT_Y * RT_SIMD_QUADS * 16;
+    s_srf->a_map[RT_K] = RT_Z * RT_SIMD_QUADS * 16;
+    s_srf->a_map[RT_L] = 0;
+
+    RT_SIMD_SET(s_srf->pos_x, box->mid[RT_X]);
+    RT_SIMD_SET(s_srf->pos_y, box->mid[RT_Y]);
+    RT_SIMD_SET(s_srf->pos_z, box->mid[RT_Z]);
+
+    /* ellipsoid around the bbox as in array's bvbox,
+     * flat sides are inflated to keep it non-degenerate */
+    RT_VEC3_SUB(dff, nd->bmax, nd->bmin);
+    rt_real d = RT_MAX(RT_MAX(dff[RT_X], dff[RT_Y]), dff[RT_Z]) / 64.0f;
+
+    dff[RT_X] = RT_MAX(dff[RT_X], d);
+    dff[RT_Y] = RT_MAX(dff[RT_Y], d);
+    dff[RT_Z] = RT_MAX(dff[RT_Z], d);
+
+    RT_SIMD_SET(s_srf->sci_w, 0.75f); /* unit cube's radius squared */
+    RT_SIMD_SET(s_srf->sci_x, 1.0f / (dff[RT_X] * dff[RT_X]));
+    RT_SIMD_SET(s_srf->sci_y, 1.0f / (dff[RT_Y] * dff[RT_Y]));
+    RT_SIMD_SET(s_srf->sci_z, 1.0f / (dff[RT_Z] * dff[RT_Z]));
+
+    nd->s_srf = s_srf;
+
+    return nd;
+}
+
+/*
+ * Group runs of adjacent surface elements in list "ptr" up to element "end"
+ * (or list's end if NULL) under scene's bvh nodes in the format of bvnodes,
+ * thus the backend skips whole groups if all rays within SIMD miss them.
+ * Runs are broken by array elements, trnode sub-lists are kept intact
+ * for cached transform, while bvnode sub-lists are grouped separately.
+ * Return last element of the list (recursive).
+ */
+rt_ELEM* rt_SceneThread::bvtree(rt_ELEM **ptr, rt_ELEM *end)
+{
+    rt_ELEM *elm = RT_NULL, *nxt, *lst, **org = RT_NULL;
+    rt_si32 num = 0;
+
+    if (scene->bvtop == RT_NULL)
+    {
+        return elm;
+    }
+
+    for (; *ptr != RT_NULL; ptr = RT_GET_ADR(elm->next))
+    {
+        nxt = *ptr;
+        lst = nxt; /* last element of the original sub-list */
+
+        rt_BOUND *box = (rt_BOUND *)nxt->temp;
+
+        if (box != RT_NULL && RT_IS_SURFACE(box) && nxt->data == 0
+        &&  RT_GET_BVI(nxt) >= 0)
+        {
+            /* accumulate surfaces in the run */
+            if (num++ == 0)
+            {
+                org = ptr;
+            }
+
+            elm = nxt;
+        }
+        else
+        {
+            /* group surfaces accumulated so far */
+            if (num > 0)
+            {
+                bvrun(org, num);
+                num = 0;
+            }
+
+            elm = nxt;
+
+            if (box != RT_NULL && RT_IS_ARRAY(box)
+            &&  RT_GET_PTR(nxt->data) != RT_NULL)
+            {
+                lst = RT_GET_PTR(nxt->data);
+                elm = lst;
+
+                /* trnode's sub-list is skipped,
+                 * bvnode's sub-list is grouped on its own */
+                if (RT_GET_FLG(nxt->data) == 1)
+                {
+                    elm = bvtree(RT_GET_ADR(nxt->next), lst);
+                    nxt->data = (rt_cell)elm | 1; /* node's type */
+                }
+            }
+        }
+
+        if (lst == end)
+        {
+            break;
+        }
+    }
+
+    if (num > 0)
+    {
+        elm = bvrun(org, num);
+    }
+
+    return elm;
+}
+
+/*
+ * Group a run of "num" surface elements at "ptr" under scene's bvh nodes.
+ * Return last element of the run.
+ */
+rt_ELEM* rt_SceneThread::bvrun(rt_ELEM **ptr, rt_si32 num)
+{
+    rt_ELEM *elm = *ptr, *nxt;
+    rt_si32 i;
+
+    for (i = 1; i < num; i++)
+    {
+        elm = elm->next;
+    }
+
+    if (num <= RT_BVH_LEAF)
+    {
+        return elm;
+    }
+
+    /* detach the run from the list for sorting */
+    nxt = elm->next;
+    elm->next = RT_NULL;
+
+   *ptr = bvsort(*ptr, num);
+
+    elm = bvlist(scene->bvtop, ptr, num);
+
+    /* attach the run back to the list */
+    elm->next = nxt;
+
+    return elm;
+}
+
+/*
+ * Insert node elements for bvh node "nd" and its subnodes ahead of
+ * their respective groups in sorted run of "num" surface elements at "ptr",
+ * nodes with only one populated subnode are omitted in favor of subnodes.
+ * Return last element of the run (recursive).
+ */
+rt_ELEM* rt_SceneThread::bvlist(rt_BVNODE *nd, rt_ELEM **ptr, rt_si32 num)
+{
+    rt_ELEM *elm = *ptr, *nxt;
+    rt_si32 i, k = 0;
+
+    /* find the smallest node containing the whole run */
+    while (num > RT_BVH_LEAF && nd != RT_NULL && nd->srf == RT_NULL)
+    {
+        for (elm = *ptr, k = 0; k < num && RT_GET_BVI(elm) < nd->mdl; k++)
+        {
+            elm = elm->next;
+        }
+
+        if (k == 0)
+        {
+            nd = nd->sub[1];
+        }
+        else
+        if (k == num)
+        {
+            nd = nd->sub[0];
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    /* leave small groups out of bvh nodes */
+    if (num <= RT_BVH_LEAF || nd == RT_NULL || nd->srf != RT_NULL)
+    {
+        for (elm = *ptr, i = 1; i < num; i++)
+        {
+            elm = elm->next;
+        }
+
+        return elm;
+    }
+
+    /* alloc new element for bvh node */
+    nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+    nxt->simd = nd->s_srf;
+    nxt->temp = nd->box;
+    /* insert element ahead of the run */
+    nxt->next = *ptr;
+   *ptr = nxt;
+
+    elm = bvlist(nd->sub[0], RT_GET_ADR(nxt->next), k);
+    elm = bvlist(nd->sub[1], RT_GET_ADR(elm->next), num - k);
+
+    /* set node's last element along with node's type */
+    nxt->data = (rt_cell)elm | 1;
+
+    return elm;
+}
+
+/*
+ * Build trnode/bvnode list for a given surface "srf"
+ * after all transform flags have been set in "update_fields",
+ * thus trnode elements are handled properly.
+ */
+rt_void rt_SceneThread::snode(rt_Surface *srf)
+{
+    /* the list is rebuilt for all surfaces whenever lists are rebuilt,
+     * including partial rebuilds (RT_OPTS_RETAIN), as it is short
+     * and depends on bounds of arrays any changed surface can affect */
+
+    /* reset surface's trnode/bvnode list */
+    srf->top = RT_NULL;
+    srf->trn = RT_NULL;
+
+    /* build surface's trnode/bvnode list,
+     * trnode hierarchy is flat as objects with
+     * non-trivial transform are their own trnodes,
+     * while bvnodes can have arbitrary depth
+     * above and below the trnode (if present) */
+    rt_ELEM *elm;
+    rt_Object *par;
+
+    /* phase 1, bvnodes (if any) below trnode (if any),
+     * if the same array serves as both trnode and bvnode,
+     * trnode is considered above only if bvnode is split,
+     * thus bvnode is inserted first in this case */
+    for (par = srf->bvnode; srf->trnode != RT_NULL && par != RT_NULL &&
+         par->trnode == srf->trnode && (par->trnode != par ||
+         ((rt_Array *)par)->trbox->rad != 0.0f);
+         par = par->bvnode)
+    {
+        rt_Array *arr = (rt_Array *)par;
+
+        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        elm->data = 0;
+        elm->simd = (rt_pntr)1; /* node's type (bv) */
+        elm->temp = arr->inbox;
+        elm->next = srf->top;
+        srf->top = elm;
+    }
+
+    /* phase 2, there can only be one trnode (if any),
+     * even though there might be other trnodes
+     * above and below in the object hierarchy
+     * they themselves don't form the hierarchy
+     * as any trnode is always its own trnode */
+    if (srf->trnode != RT_NULL && srf->trnode != srf)
+    {
+        rt_Array *arr = (rt_Array *)srf->trnode;
+
+        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        elm->data = 0;
+        elm->simd = (rt_pntr)0; /* node's type (tr) */
+        elm->temp = arr->trbox->rad != 0.0f ? arr->trbox : arr->inbox;
+        elm->next = srf->top;
+        srf->top = elm;
+
+        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        elm->data = 0;
+        elm->simd = (rt_pntr)0; /* node's type (tr) */
+        elm->temp = srf->top->temp;
+        elm->next = RT_NULL;
+        srf->trn = elm;
+    }
+
+    /* phase 3, bvnodes (if any) above trnode (if any) */
+    for (; par != RT_NULL; par = par->bvnode)
+    {
+        rt_Array *arr = (rt_Array *)par;
+
+        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        elm->data = 0;
+        elm->simd = (rt_pntr)1; /* node's type (bv) */
+        elm->temp = arr->bvbox->rad != 0.0f ? arr->bvbox : arr->inbox;
+        elm->next = srf->top;
+        srf->top = elm;
+    }
+}
+
+/*
+ * Build custom clippers list from "srf" relations template
+ * after all transform flags have been set in "update_fields",
+ * thus trnode elements are handled properly.
+ */
+rt_void rt_SceneThread::sclip(rt_Surface *srf)
+{
+#if RT_OPTS_RETAIN != 0
+    /* keep the list retained from previous frame (RT_OPTS_RETAIN)
+     * if neither surface nor any of its clippers changed */
+    if (scene->rpart && srf->obj_changed == 0)
+    {
+        rt_ELEM *elm;
+
+        for (elm = srf->rel; elm != RT_NULL; elm = elm->next)
+        {
+            rt_Object *obj = elm->temp == RT_NULL ? RT_NULL :
+                             (rt_Object *)((rt_BOUND *)elm->temp)->obj;
+
+            if (obj != RT_NULL && obj->obj_changed)
+            {
+                break;
+            }
+        }
+
+        if (elm == RT_NULL)
+        {
+            return;
+        }
+    }
+#endif /* RT_OPTS_RETAIN */
+
+
+    /* init surface's relations template */
+    rt_ELEM *lst = srf->rel;
+
+    /* init and reset custom clippers list */
+    rt_ELEM **ptr = RT_GET_ADR(srf->s_srf->msc_p[2]);
+   *ptr = RT_NULL;
+
+    /* build custom clippers list from given template "lst",
+     * as given template "lst" is inverted in surface's "add_relation"
+     * and elements are inserted into the list's head here,
+     * the original relations template from scene data is inverted twice,
+     * thus accum enter/leave markers will end up in correct order */
+    for (; lst != RT_NULL; lst = lst->next)
+    {
+        rt_ELEM *elm;
+        rt_cell rel = lst->data;
+        rt_Object *obj = lst->temp == RT_NULL ? RT_NULL :
+                         (rt_Object *)((rt_BOUND *)lst->temp)->obj;
+
+        if (obj == RT_NULL)
+        {
+            /* alloc new element for accum marker */
+            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+            elm->data = rel;
+            elm->simd = RT_NULL; /* accum marker */
+            elm->temp = RT_NULL;
+            /* insert element as list's head */
+            elm->next = *ptr;
+           *ptr = elm;
+        }
+        else
+        if (RT_IS_SURFACE(obj))
+        {
+            rt_Surface *srf = (rt_Surface *)obj;
+
+            /* alloc new element for "srf" */
+            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+            elm->data = rel;
+            elm->simd = srf->s_srf;
+            elm->temp = srf->bvbox;
+
+            if (srf->trnode != RT_NULL && srf->trnode != srf)
+            {
+                rt_si32 acc = 0;
+                rt_ELEM *nxt;
+
+                rt_Array *arr = (rt_Array *)srf->trnode;
+                rt_BOUND *trb = arr->trbox; /* not used for clippers */
+
+                /* search matching existing trnode for insertion
+                 * either within current accum segment
+                 * or outside of any accum segment */
+                for (nxt = *ptr; nxt != RT_NULL; nxt = nxt->next)
+                {
+                    /* "acc == 0" either accum-enter-marker
+                     * hasn't been inserted yet (current accum segment)
+                     * or outside of any accum segment */
+                    if (acc == 0
+                    &&  nxt->temp == trb)
+                    {
+                        break;
+                    }
+
+                    /* skip all non-accum-marker elements */
+                    if (nxt->temp != RT_NULL)
+                    {
+                        continue;
+                    }
+
+                    /* didn't find trnode within current accum segment,
+                     * leaving cycle, new trnode element will be inserted */
+                    if (acc == 0
+                    &&  nxt->data == RT_ACCUM_LEAVE)
+                    {
+                        nxt = RT_NULL;
+                        break;
+                    }
+
+                    /* skip accum segment different from the one
+                     * current element is being inserted into */
+                    if (acc == 0
+                    &&  nxt->data == RT_ACCUM_ENTER)
+                    {
+                        acc = 1;
+                    }
+
+                    /* keep track of accum segments */
+                    if (acc == 1
+                    &&  nxt->data == RT_ACCUM_LEAVE)
+                    {
+                        acc = 0;
+                    }
+                }
+
+                if (nxt == RT_NULL)
+                {
+                    /* insert element as list's head */
+                    elm->next = *ptr;
+                   *ptr = elm;
+
+                    /* alloc new trnode element as none has been found */
+                    nxt = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                    nxt->data = (rt_cell)elm; /* trnode's last element */
+                    nxt->simd = arr->s_srf;
+                    nxt->temp = trb;
+                    /* insert element as list's head */
+                    nxt->next = *ptr;
+                   *ptr = nxt;
+                }
+                else
+                {
+                    /* insert element under existing trnode */
+                    elm->next = nxt->next;
+                    nxt->next = elm;
+                }
+            }
+            else
+            {
+                /* insert element as list's head */
+                elm->next = *ptr;
+               *ptr = elm;
+            }
+        }
+    }
+}
+
+/*
+ * Build tile list for a given surface "srf" based
+ * on the area its projected bbox occupies in the tilebuffer.
+ */
+rt_void rt_SceneThread::stile(rt_Surface *srf)
+{
+    /* the list is rebuilt for all surfaces whenever tiling is redone,
+     * as its elements are linked into the tilebuffer in "tsort" */
+
+    srf->tls = RT_NULL;
+    srf->tly = 0;
+    srf->tlh = 0;
+
+#if RT_OPTS_TILING != 0
+    if ((scene->opts & RT_OPTS_TILING) == 0)
+#endif /* RT_OPTS_TILING */
+    {
+        return;
+    }
+
+    rt_ELEM *elm;
+    rt_si32 i, j;
+    rt_si32 k;
 
     rt_vec4 vec;
     rt_real dot;
@@ -2135,11 +2778,26 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
         }
     }
 
-    rt_ELEM **ptr = RT_GET_ADR(srf->tls);
+    /* find range of marked tile rows */
+    for (i = 0; i < scene->tiles_in_col && txmin[i] > txmax[i]; i++);
+    for (k = scene->tiles_in_col; k > i && txmin[k-1] > txmax[k-1]; k--);
+
+    if (i == k)
+    {
+        return;
+    }
+
+    /* separate list for each tile row allows
+     * binning rows into the tilebuffer in parallel */
+    srf->tls = (rt_ELEM **)alloc(sizeof(rt_ELEM *) * (k - i), RT_ALIGN);
+    srf->tly = i;
+    srf->tlh = k - i;
 
     /* fill marked tiles with surface data */
-    for (i = 0; i < scene->tiles_in_col; i++)
+    for (; i < k; i++)
     {
+        rt_ELEM **ptr = RT_GET_ADR(srf->tls[i - srf->tly]);
+
         for (j = txmin[i]; j <= txmax[i]; j++)
         {
             /* alloc new element for each tile of "srf" */
@@ -2151,9 +2809,186 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
            *ptr = elm;
             ptr = &elm->next;
         }
+
+       *ptr = RT_NULL;
     }
+}
 
-   *ptr = RT_NULL;
+/*
+ * Bin surfaces' tile lists into the tilebuffer
+ * for tile rows with given thread's "index",
+ * all rows are covered once by "thnum" threads.
+ */
+rt_void rt_SceneThread::tsort()
+{
+    rt_ELEM **tiles = scene->tiles;
+    rt_si32 tiles_in_row = scene->tiles_in_row;
+    rt_si32 tiles_in_col = scene->tiles_in_col;
+    rt_si32 thnum = scene->thnum;
+    rt_si32 i, j, k, tline;
+
+#if RT_OPTS_TILING != 0
+    if ((scene->opts & RT_OPTS_TILING) == 0)
+#endif /* RT_OPTS_TILING */
+    {
+        for (i = index; i < tiles_in_col; i += thnum)
+        {
+            tline = i * tiles_in_row;
+
+            for (j = 0; j < tiles_in_row; j++)
+            {
+                tiles[tline + j] = scene->clist;
+            }
+        }
+
+        return;
+    }
+
+#if RT_PROFILE != 0
+    p_tls = get_usec();
+#endif /* RT_PROFILE */
+
+    for (i = index; i < tiles_in_col; i += thnum)
+    {
+        memset(tiles + i * tiles_in_row, 0, sizeof(rt_ELEM *) * tiles_in_row);
+    }
+
+    rt_ELEM *elm, *nxt, *ctail = RT_NULL, **ptr = &ctail;
+
+    /* build exact copy of reversed "clist" (should be cheap),
+     * trnode elements become tailing rather than heading,
+     * elements grouping for cached transform is retained,
+     * each thread keeps its own copy to avoid a serial step */
+    for (nxt = scene->clist; nxt != RT_NULL; nxt = nxt->next)
+    {
+        /* alloc new element as "nxt's" copy */
+        elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+        elm->data = nxt->data;
+        elm->simd = nxt->simd;
+        elm->temp = nxt->temp;
+        /* insert element as list's head */
+        elm->next = *ptr;
+       *ptr = elm;
+    }
+
+    /* traverse reversed "clist" to keep original "clist's" order
+     * and optimize trnode handling for each tile */
+    for (elm = ctail; elm != RT_NULL; elm = elm->next)
+    {
+        rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
+
+        /* skip trnode elements from reversed "clist"
+         * as they are handled separately for each tile */
+        if (RT_IS_ARRAY(nd))
+        {
+            continue;
+        }
+
+        rt_Surface *srf = (rt_Surface *)nd;
+
+        rt_si32 b = 0;
+
+#if RT_OPTS_VARRAY != 0
+        /* precede bounded non-plane surfaces with their bvbox
+         * in the format of bvnode for the backend to skip them
+         * if all rays within SIMD miss surface's bounding sphere,
+         * planes are left out as their solver is cheap enough */
+        if ((scene->opts & RT_OPTS_VARRAY) != 0 && !RT_IS_PLANE(srf)
+        &&  srf->bvbox->verts_num != 0 && srf->bvbox->rad != RT_INF)
+        {
+            b = 1;
+        }
+#endif /* RT_OPTS_VARRAY */
+
+        /* first surface's row belonging to this thread */
+        k = srf->tly + (index + thnum - srf->tly % thnum) % thnum;
+
+        for (; k < srf->tly + srf->tlh; k += thnum)
+        {
+            rt_ELEM *tls = srf->tls[k - srf->tly], *trn, *bvb;
+
+            if (srf->trnode != RT_NULL && srf->trnode != srf)
+            {
+                for (; tls != RT_NULL; tls = nxt)
+                {
+                    i = (rt_word)tls->data >> 16;
+                    j = (rt_word)tls->data & 0xFFFF;
+
+                    nxt = tls->next;
+
+                    tls->data = 0;
+
+                    tline = i * tiles_in_row;
+
+                    /* check matching existing trnode for insertion,
+                     * only tile list's head needs to be checked as elements
+                     * grouping for cached transform is retained from "clist" */
+                    trn = tiles[tline + j];
+
+                    rt_Array *arr = (rt_Array *)srf->trnode;
+                    rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+
+                    if (trn != RT_NULL && trn->temp == trb)
+                    {
+                        /* insert element under existing trnode */
+                        tls->next = trn->next;
+                        trn->next = tls;
+                    }
+                    else
+                    {
+                        /* insert element as list's head */
+                        tls->next = tiles[tline + j];
+                        tiles[tline + j] = tls;
+
+                        /* alloc new trnode element as none has been found */
+                        trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                        trn->data = (rt_cell)tls; /* trnode's last element */
+                        trn->simd = arr->s_srf;
+                        trn->temp = trb;
+                        /* insert element as list's head */
+                        trn->next = tiles[tline + j];
+                        tiles[tline + j] = trn;
+                    }
+                }
+            }
+            else
+            {
+                for (; tls != RT_NULL; tls = nxt)
+                {
+                    i = (rt_word)tls->data >> 16;
+                    j = (rt_word)tls->data & 0xFFFF;
+
+                    nxt = tls->next;
+
+                    tls->data = 0;
+
+                    tline = i * tiles_in_row;
+
+                    /* insert element as list's head */
+                    tls->next = tiles[tline + j];
+                    tiles[tline + j] = tls;
+
+                    if (b == 0)
+                    {
+                        continue;
+                    }
+
+                    /* alloc new bvbox element for surface's tile */
+                    bvb = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
+                    bvb->data = (rt_cell)tls | 1; /* node's type */
+                    bvb->simd = srf->s_bvb;
+                    bvb->temp = srf->bvbox;
+                    /* insert element as list's head */
+                    bvb->next = tiles[tline + j];
+                    tiles[tline + j] = bvb;
+                }
+            }
+        }
+    }
+
+#if RT_PROFILE != 0
+    p_tls = get_usec() - p_tls;
+#endif /* RT_PROFILE */
 }
 
 /*
@@ -2162,8 +2997,8 @@ rt_void rt_SceneThread::stile(rt_Surface *srf)
  */
 rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* the list is rebuilt whenever lists are rebuilt, including partial
+     * rebuilds (RT_OPTS_RETAIN) as changed surfaces can be seen anywhere */
 
     rt_Surface *srf = RT_NULL;
     rt_ELEM **pto = RT_NULL;
@@ -2446,6 +3281,26 @@ rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
     }
 #endif /* RT_OPTS_INSERT, RT_OPTS_TARRAY, RT_OPTS_VARRAY */
 
+#if RT_OPTS_VARRAY_EXT1 != 0
+    if ((scene->opts & RT_OPTS_VARRAY_EXT1) != 0)
+    {
+        if (pto != RT_NULL && *pto != RT_NULL)
+        {
+            bvtree(pto, RT_NULL);
+        }
+        if (pti != RT_NULL && *pti != RT_NULL)
+        {
+            bvtree(pti, RT_NULL);
+        }
+        /* camera's list is left intact as SIMD-buffers
+         * are flushed across primary list's surfaces only */
+        if (*ptr != RT_NULL && srf != RT_NULL) /* "slist" is grouped in render */
+        {
+            bvtree(ptr, RT_NULL);
+        }
+    }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+
     if (srf == RT_NULL)
     {
         return lst;
@@ -2484,8 +3339,8 @@ rt_ELEM* rt_SceneThread::ssort(rt_Object *obj)
  */
 rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
 {
-    /* as temporary memory pool is released after every frame,
-     * always rebuild the list even if the scene hasn't changed */
+    /* the list is rebuilt whenever lists are rebuilt, surface's lists
+     * are kept in partial rebuilds (RT_OPTS_RETAIN) if "sdeps" allows */
 
     rt_Surface *srf = RT_NULL;
     rt_ELEM **pto = RT_NULL;
@@ -2509,8 +3364,38 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
         else
 #endif /* RT_OPTS_SHADOW */
         {
-           *pto = scene->llist; /* all lgt are potential sources */
-           *pti = scene->llist; /* all lgt are potential sources */
+            rt_ELEM *lst = RT_NULL;
+            rt_Light *lgt;
+
+            /* check if all lgt are in range of the surface */
+            for (lgt = scene->lgt_head; lgt != RT_NULL; lgt = lgt->next)
+            {
+                if (bbox_dist(lgt->bvbox, lgt->rng, srf->bvbox) == 0)
+                {
+                    break;
+                }
+            }
+
+            if (lgt == RT_NULL)
+            {
+               *pto = scene->llist; /* all lgt are potential sources */
+               *pti = scene->llist; /* all lgt are potential sources */
+
+                return RT_NULL;
+            }
+
+            /* only lgt in range are potential sources,
+             * keep the order of global light/shadow list */
+            for (lgt = scene->lgt_head; lgt != RT_NULL; lgt = lgt->next)
+            {
+                if (bbox_dist(lgt->bvbox, lgt->rng, srf->bvbox) != 0)
+                {
+                    insert(lgt, &lst, RT_NULL);
+                }
+            }
+
+           *pto = lst;
+           *pti = lst;
 
             return RT_NULL;
         }
@@ -2523,6 +3408,14 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
     /* linear traversal across light sources */
     for (lgt = scene->lgt_head; lgt != RT_NULL; lgt = lgt->next)
     {
+        /* skip lgt if the surface is out of its range,
+         * saves both lighting and shadow tests in backend */
+        if (srf != RT_NULL
+        &&  bbox_dist(lgt->bvbox, lgt->rng, srf->bvbox) == 0)
+        {
+            continue;
+        }
+
         rt_ELEM **pso = RT_NULL;
         rt_ELEM **psi = RT_NULL;
         rt_ELEM **psr = RT_NULL;
@@ -2747,6 +3640,24 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
         }
 #endif /* RT_OPTS_INSERT, RT_OPTS_TARRAY, RT_OPTS_VARRAY */
 
+#if RT_OPTS_VARRAY_EXT1 != 0
+        if ((scene->opts & RT_OPTS_VARRAY_EXT1) != 0)
+        {
+            if (pso != RT_NULL && *pso != RT_NULL)
+            {
+                bvtree(pso, RT_NULL);
+            }
+            if (psi != RT_NULL && *psi != RT_NULL)
+            {
+                bvtree(psi, RT_NULL);
+            }
+            if (psr != RT_NULL && *psr != RT_NULL)
+            {
+                bvtree(psr, RT_NULL);
+            }
+        }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+
         if (g_print)
         {
             if (pso != RT_NULL && *pso != RT_NULL)
@@ -2778,7 +3689,55 @@ rt_ELEM* rt_SceneThread::lsort(rt_Object *obj)
        *pti = lst;
     }
 
-    return RT_NULL;
+    return RT_NULL;
+}
+
+/*
+ * Check if light/shadow lists of surface "srf" retained from previous frame
+ * depend on surfaces changed in this frame (linked from "rsrf"),
+ * return 1 if lists need to be rebuilt, 0 if they can be kept.
+ * Changed surface can only enter or leave the shadow list if it casts
+ * shadow on "srf" either with its new bounds or with the bounds the list
+ * was built with, new bounds are checked with the same test "lsort" uses,
+ * while old ones are checked with its bounding sphere part only.
+ */
+rt_si32 rt_SceneThread::sdeps(rt_Surface *srf)
+{
+    if (srf->srf_changed)
+    {
+        return 1;
+    }
+
+#if RT_OPTS_SHADOW != 0
+    if ((scene->opts & RT_OPTS_SHADOW) == 0)
+#endif /* RT_OPTS_SHADOW */
+    {
+        /* light lists refer to global lists, cheap to rebuild */
+        return 1;
+    }
+
+    rt_Light *lgt;
+    rt_Surface *ref;
+
+    for (lgt = scene->lgt_head; lgt != RT_NULL; lgt = lgt->next)
+    {
+        /* lights out of range have no shadow lists */
+        if (bbox_dist(lgt->bvbox, lgt->rng, srf->bvbox) == 0)
+        {
+            continue;
+        }
+
+        for (ref = scene->rsrf; ref != RT_NULL; ref = ref->rnxt)
+        {
+            if (bbox_shad(lgt->bvbox, ref->bvbox, srf->bvbox)
+            ||  sphr_shad(lgt->bvbox, ref->rmid, ref->rrad, srf->bvbox))
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
 }
 
 /*
@@ -2824,6 +3783,9 @@ rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
 {
     this->pfm = pfm;
 
+    /* follow platform's chunk size classes */
+    set_huge(pfm->get_huge());
+
     pfm->add_scene(this);
 
     thnum = pfm->thnum;
@@ -2903,6 +3865,8 @@ rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
     depth = RT_MAX(RT_STACK_DEPTH, 0);
     opts &= ~scn->opts;
 
+    fnext = RT_NULL;
+
     pseed = RT_NULL;
     ptr_r = RT_NULL;
     ptr_g = RT_NULL;
@@ -2985,6 +3949,40 @@ rt_Scene::rt_Scene(rt_SCENE *scn, /* "frame" must be SIMD-aligned or NULL */
 
     pending = 0;
 
+#if RT_PROFILE != 0
+    /* init profiling data of the last frame */
+    memset(&prof, 0, sizeof(rt_PROFILE));
+
+    prof.thnum = thnum;
+    prof.t_thr = (rt_time *)alloc(sizeof(rt_time) * thnum, RT_ALIGN);
+    prof.t_idl = (rt_time *)alloc(sizeof(rt_time) * thnum, RT_ALIGN);
+
+    memset(prof.t_thr, 0, sizeof(rt_time) * thnum);
+    memset(prof.t_idl, 0, sizeof(rt_time) * thnum);
+
+    /* alloc framebuffer's cost-plane for heatmap,
+     * same stride and orientation as the framebuffer */
+    hmap = (rt_ui32 *)
+            alloc(RT_ABS32(x_row) * y_res * sizeof(rt_ui32), RT_SIMD_ALIGN);
+
+    if (x_row < 0)
+    {
+        hmap += RT_ABS32(x_row) * (y_res - 1);
+    }
+
+    hm_on = 0;
+#endif /* RT_PROFILE */
+
+    /* init state for lists retained across frames */
+    cpool = RT_NULL;
+    rcam  = RT_NULL;
+    rsimd = 0;
+    rpart = 0;
+    rsrf  = RT_NULL;
+    rsize = 0;
+    rused = 0;
+    rfull = 0;
+
     /* init memory pool in the heap for temporary per-frame allocs */
     mpool = RT_NULL; /* rough estimate for surface relations/templates */
     msize = ((srf_num + 1) * (srf_num + 1) * 2 + /* plus two surface lists */
@@ -3015,41 +4013,125 @@ rt_void rt_Scene::render(rt_time time)
 {
     rt_si32 i;
 
+    /* lists retained from previous frame:
+     * 0 - none, 1 - camera-independent, 2 - all */
+    rt_si32 retain = 0;
+
+    /* camera-independent lists are rebuilt
+     * only for changed surfaces if set below */
+    rpart = 0;
+
+    /* lists are kept if update is skipped */
+    rfull = 0;
+
+#if RT_PROFILE != 0
+    prof.t_upd[0] = 0;
+#endif /* RT_PROFILE */
+
 #if RT_OPTS_UPDATE_EXT0 != 0
     if ((opts & RT_OPTS_UPDATE_EXT0) == 0 || rootobj.time == -1)
     { /* -->---->-- skip update1 -->---->-- */
 #endif /* RT_OPTS_UPDATE_EXT0 */
 
-    if (pending)
+    /* print state init */
+    if (g_print)
     {
-        pending = 0;
+        RT_PRINT_STATE_INIT();
+        RT_PRINT_TIME(time);
+    }
 
-        /* release memory for temporary per-frame allocs */
-        for (i = 0; i < thnum; i++)
+#if RT_PROFILE != 0
+    prof.t_upd[0] = get_usec();
+#endif /* RT_PROFILE */
+
+    /* phase 0.5, hierarchical update of arrays' transform matrices */
+    root->update_object(time, 0, RT_NULL, iden4);
+
+#if RT_PROFILE != 0
+    prof.t_upd[0] = get_usec() - prof.t_upd[0];
+#endif /* RT_PROFILE */
+
+#if RT_OPTS_RETAIN != 0
+    if ((opts & RT_OPTS_RETAIN) != 0 && pending && cpool != RT_NULL
+    &&  rcam == cam && rsimd == pfm->simd && !g_print)
+    {
+        retain = 2;
+
+        rt_Light   *lgt;
+        rt_Surface *srf;
+
+        /* lists built in previous frame are dropped
+         * if any of the lights changed, as every light list
+         * and every shadow list would need to be rebuilt */
+        for (lgt = lgt_head; lgt != RT_NULL && retain; lgt = lgt->next)
+        {
+            retain = lgt->obj_changed ? 0 : retain;
+        }
+
+        /* otherwise changed surfaces only trigger partial rebuild
+         * of camera-independent lists, array changes propagate
+         * to surfaces, while cameras and lights aren't in lists */
+        for (srf = srf_head; srf != RT_NULL && retain; srf = srf->next)
+        {
+            rpart |= srf->obj_changed;
+        }
+
+        /* lists replaced in partial rebuilds are only released
+         * along with the rest, rebuild all once they pile up */
+        if (retain && rpart && rused > rsize * 2)
+        {
+            retain = 0;
+        }
+
+        /* camera-dependent lists are rebuilt if camera changed
+         * or partial rebuild is done, as tile lists of surfaces
+         * are consumed by binning them into the tilebuffer */
+        if (retain && (rpart || cam->obj_changed))
         {
-            tharr[i]->release(tharr[i]->mpool);
+            retain = 1;
         }
 
-        release(mpool);
+        rpart = retain ? rpart : 0;
     }
+#endif /* RT_OPTS_RETAIN */
 
-    /* reserve memory for temporary per-frame allocs */
-    mpool = reserve(msize, RT_QUAD_ALIGN);
+    /* all lists are built from scratch */
+    rfull = retain == 0;
 
-    for (i = 0; i < thnum; i++)
+    if (pending && retain == 0)
     {
-        tharr[i]->mpool = tharr[i]->reserve(tharr[i]->msize, RT_QUAD_ALIGN);
+        pending = 0;
+
+        /* release memory for temporary per-frame allocs */
+        reset_mpool();
     }
 
-    /* print state init */
-    if (g_print)
+    if (retain == 0)
     {
-        RT_PRINT_STATE_INIT();
-        RT_PRINT_TIME(time);
+        /* reserve memory for temporary per-frame allocs */
+        mpool = reserve(msize, RT_QUAD_ALIGN);
+
+        /* per-thread memory is reserved by threads in 1st phase */
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->mpool = RT_NULL;
+        }
+
+        cpool = RT_NULL;
     }
+    else
+    if (retain == 1)
+    {
+        /* release memory for camera-dependent allocs only,
+         * partial rebuild of camera-independent lists
+         * is placed before the new checkpoint */
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->release(tharr[i]->cpool);
+        }
 
-    /* phase 0.5, hierarchical update of arrays' transform matrices */
-    root->update_object(time, 0, RT_NULL, iden4);
+        release(cpool);
+    }
 
     if (pt_on && (root->scn_changed || pfm->fsaa != fsaa))
     {
@@ -3100,6 +4182,11 @@ rt_void rt_Scene::render(rt_time time)
     RT_VEC3_MUL_VAL1(htl, hor, h);
     RT_VEC3_MUL_VAL1(vtl, ver, v);
 
+#if RT_OPTS_RETAIN != 0
+    if (retain == 0 || rpart)
+    { /* -->---->-- skip rebuild -->---->-- */
+#endif /* RT_OPTS_RETAIN */
+
     /* 2nd phase of multi-threaded update */
 #if RT_OPTS_THREAD != 0
     if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
@@ -3116,41 +4203,92 @@ rt_void rt_Scene::render(rt_time time)
         update_scene(this, -thnum, 2);
     }
 
-    /* phase 2.5, hierarchical update of arrays' bounds from surfaces */
-    root->update_bounds();
-
-    rt_Surface *srf;
+#if RT_OPTS_RETAIN != 0
+    /* link surfaces changed in 2nd phase above,
+     * lists of other surfaces are checked against them */
+    rsrf = RT_NULL;
 
-    /* update surfaces' node lists */
-    for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+    if (rpart)
     {
-        /* rebuild surface's node list (per-surface)
-         * based on transform flags and arrays' bounds */
-        tharr[0]->snode(srf);
+        rt_Surface *srf;
+
+        for (srf = srf_head; srf != RT_NULL; srf = srf->next)
+        {
+            if (srf->srf_changed)
+            {
+                srf->rnxt = rsrf;
+                rsrf = srf;
+            }
+        }
     }
+#endif /* RT_OPTS_RETAIN */
 
-    /* rebuild global hierarchical list */
-    hlist = tharr[0]->ssort(RT_NULL);
+    /* phase 2.5, hierarchical update of arrays' bounds from surfaces,
+     * root's sub-arrays are updated in multi-threaded phase first */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 5);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 5);
+    }
 
-    /* rebuild global surface/node list */
-    slist = tharr[0]->ssort(RT_NULL);
-    tharr[0]->filter(RT_NULL, &slist);
+    /* reduce sub-arrays' bounds into root's bounds */
+    root->update_bounds();
 
-    /* rebuild global light/shadow list,
-     * "slist" is needed inside */
-    llist = tharr[0]->lsort(RT_NULL);
+    /* update surfaces' node lists
+     * based on transform flags and arrays' bounds */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 6);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 6);
+    }
 
-    /* rebuild camera's surface/node list,
-     * "slist" is needed inside */
-    clist = tharr[0]->ssort(cam);
+    /* rebuild global hierarchical, surface/node, light/shadow
+     * and camera's lists in multi-threaded phase */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 7);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 7);
+    }
 
     if (g_print)
     {
         RT_PRINT_GLB();
         RT_PRINT_SRF_LST(slist);
         RT_PRINT_LGT_LST(llist);
-        RT_PRINT_CAM(cam);
-        RT_PRINT_SRF_LST(clist);
+#if RT_OPTS_RETAIN != 0
+        if ((opts & RT_OPTS_RETAIN) == 0)
+#endif /* RT_OPTS_RETAIN */
+        {
+            RT_PRINT_CAM(cam);
+            RT_PRINT_SRF_LST(clist);
+        }
     }
 
     /* 3rd phase of multi-threaded update */
@@ -3169,133 +4307,100 @@ rt_void rt_Scene::render(rt_time time)
         update_scene(this, -thnum, 3);
     }
 
-    /* screen tiling */
-    rt_si32 tline, j;
+#if RT_OPTS_RETAIN != 0
+    } /* --<----<-- skip rebuild --<----<-- */
+#endif /* RT_OPTS_RETAIN */
 
-#if RT_OPTS_TILING != 0
-    if ((opts & RT_OPTS_TILING) != 0)
-    {
-        memset(tiles, 0, sizeof(rt_ELEM *) * tiles_in_row * tiles_in_col);
+#if RT_OPTS_RETAIN != 0
+    if ((opts & RT_OPTS_RETAIN) != 0 && retain < 2)
+    { /* -->---->-- camera lists -->---->-- */
 
-        rt_ELEM *elm, *nxt, *ctail = RT_NULL, **ptr = &ctail;
+    if (retain == 0 || rpart)
+    {
+        /* set memory pool checkpoints, allocs made afterwards
+         * depend on camera and are released once it changes */
+        cpool = reserve(0, RT_QUAD_ALIGN);
 
-        /* build exact copy of reversed "clist" (should be cheap),
-         * trnode elements become tailing rather than heading,
-         * elements grouping for cached transform is retained */
-        for (nxt = clist; nxt != RT_NULL; nxt = nxt->next)
-        {
-            /* alloc new element as "nxt's" copy */
-            elm = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-            elm->data = nxt->data;
-            elm->simd = nxt->simd;
-            elm->temp = nxt->temp;
-            /* insert element as list's head */
-            elm->next = *ptr;
-           *ptr = elm;
-        }
+        rt_size size = usage(mpool);
 
-        /* traverse reversed "clist" to keep original "clist's" order
-         * and optimize trnode handling for each tile */
-        for (elm = ctail; elm != RT_NULL; elm = elm->next)
+        for (i = 0; i < thnum; i++)
         {
-            rt_Node *nd = (rt_Node *)((rt_BOUND *)elm->temp)->obj;
-
-            /* skip trnode elements from reversed "clist"
-             * as they are handled separately for each tile */
-            if (RT_IS_ARRAY(nd))
-            {
-                continue;
-            }
-
-            rt_Surface *srf = (rt_Surface *)nd;
-
-            rt_ELEM *tls = srf->tls, *trn;
-
-            if (srf->trnode != RT_NULL && srf->trnode != srf)
-            {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
-
-                    nxt = tls->next;
-
-                    tls->data = 0;
+            tharr[i]->cpool = tharr[i]->reserve(0, RT_QUAD_ALIGN);
 
-                    tline = i * tiles_in_row;
+            size += tharr[i]->usage(tharr[i]->mpool);
+        }
 
-                    /* check matching existing trnode for insertion,
-                     * only tile list's head needs to be checked as elements
-                     * grouping for cached transform is retained from "clist" */
-                    trn = tiles[tline + j];
+        /* keep track of lists replaced in partial rebuilds */
+        rsize = retain == 0 ? size : rsize;
+        rused = size;
+    }
 
-                    rt_Array *arr = (rt_Array *)srf->trnode;
-                    rt_BOUND *trb = (rt_BOUND *)srf->trn->temp;
+    /* rebuild camera's surface/node list,
+     * "slist" is needed inside */
+    clist = tharr[0]->ssort(cam);
 
-                    if (trn != RT_NULL && trn->temp == trb)
-                    {
-                        /* insert element under existing trnode */
-                        tls->next = trn->next;
-                        trn->next = tls;
-                    }
-                    else
-                    {
-                        /* insert element as list's head */
-                        tls->next = tiles[tline + j];
-                        tiles[tline + j] = tls;
+    if (g_print)
+    {
+        RT_PRINT_CAM(cam);
+        RT_PRINT_SRF_LST(clist);
+    }
 
-                        /* alloc new trnode element as none has been found */
-                        trn = (rt_ELEM *)alloc(sizeof(rt_ELEM), RT_QUAD_ALIGN);
-                        trn->data = (rt_cell)tls; /* trnode's last element */
-                        trn->simd = arr->s_srf;
-                        trn->temp = trb;
-                        /* insert element as list's head */
-                        trn->next = tiles[tline + j];
-                        tiles[tline + j] = trn;
-                    }
-                }
-            }
-            else
-            {
-                for (; tls != RT_NULL; tls = nxt)
-                {
-                    i = (rt_word)tls->data >> 16;
-                    j = (rt_word)tls->data & 0xFFFF;
+    /* 4th phase of multi-threaded update */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 4);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 4);
+    }
 
-                    nxt = tls->next;
+    } /* --<----<-- camera lists --<----<-- */
+#endif /* RT_OPTS_RETAIN */
 
-                    tls->data = 0;
+#if RT_OPTS_RETAIN != 0
+    if ((opts & RT_OPTS_RETAIN) != 0 && retain < 2)
+    { /* -->---->-- camera tiling -->---->-- */
 
-                    tline = i * tiles_in_row;
+    /* 8th phase of multi-threaded update,
+     * bin tile lists built in 4th phase,
+     * fused into 3rd phase without RETAIN */
+#if RT_OPTS_THREAD != 0
+    if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene() && !g_print
+#if RT_OPTS_UPDATE_EXT2 != 0
+    &&  (opts & RT_OPTS_UPDATE_EXT2) == 0
+#endif /* RT_OPTS_UPDATE_EXT2 */
+       )
+    {
+        this->f_update(tdata, thnum, 8);
+    }
+    else
+#endif /* RT_OPTS_THREAD */
+    {
+        update_scene(this, -thnum, 8);
+    }
 
-                    /* insert element as list's head */
-                    tls->next = tiles[tline + j];
-                    tiles[tline + j] = tls;
-                }
-            }
-        }
+    } /* --<----<-- camera tiling --<----<-- */
 
-        if (g_print)
+    if (retain < 2)
+#endif /* RT_OPTS_RETAIN */
+    {
+#if RT_OPTS_TILING != 0
+        if (g_print && (opts & RT_OPTS_TILING) != 0)
         {
-            rt_si32 i = 0, j = 0;
+            rt_si32 i = 0, j = 0, tline;
 
             tline = i * tiles_in_row;
 
             RT_PRINT_TLS_LST(tiles[tline + j], i, j);
         }
-    }
-    else
 #endif /* RT_OPTS_TILING */
-    {
-        for (i = 0; i < tiles_in_col; i++)
-        {
-            tline = i * tiles_in_row;
-
-            for (j = 0; j < tiles_in_row; j++)
-            {
-                tiles[tline + j] = clist;
-            }
-        }
     }
 
     /* aim rays at pixel centers */
@@ -3331,6 +4436,27 @@ rt_void rt_Scene::render(rt_time time)
     reset_color();
 #endif /* enable for SIMD-buffers as a debug option if needed */
 
+#if RT_OPTS_THREAD_EXT1 != 0
+    if ((opts & RT_OPTS_THREAD_EXT1) != 0)
+    {
+        /* split tilebuffer into tile-row jobs,
+         * contiguous ranges are queued per thread for locality,
+         * threads that run out of jobs steal from other queues */
+        for (i = 0; i < thnum; i++)
+        {
+            tharr[i]->jhead = tiles_in_col * (i + 0) / thnum;
+            tharr[i]->jtail = tiles_in_col * (i + 1) / thnum;
+        }
+    }
+#endif /* RT_OPTS_THREAD_EXT1 */
+
+    /* take framebuffer from set_frame (if any) for this render */
+    if (fnext != RT_NULL)
+    {
+        frame = fnext;
+        fnext = RT_NULL;
+    }
+
     /* multi-threaded render */
 #if RT_OPTS_THREAD != 0
     if ((opts & RT_OPTS_THREAD) != 0 && this == pfm->get_cur_scene()
@@ -3347,12 +4473,22 @@ rt_void rt_Scene::render(rt_time time)
         render_scene(this, -thnum, 1);
     }
 
-    pts_c = tharr[0]->s_inf->pts_c[0];
+    /* threads left without tile-row jobs
+     * keep path-tracer's previous sample counter */
+    for (i = 0; i < thnum; i++)
+    {
+        pts_c = RT_MAX(pts_c, tharr[i]->s_inf->pts_c[0]);
+    }
 
 #if RT_OPTS_RENDER_EXT0 != 0
     } /* --<----<-- skip render0 --<----<-- */
 #endif /* RT_OPTS_RENDER_EXT0 */
 
+#if RT_PROFILE != 0
+    /* gather profiling data of the frame */
+    profile();
+#endif /* RT_PROFILE */
+
 
 #if RT_OPTS_UPDATE_EXT0 != 0
     if ((opts & RT_OPTS_UPDATE_EXT0) == 0)
@@ -3366,14 +4502,23 @@ rt_void rt_Scene::render(rt_time time)
         g_print = RT_FALSE;
     }
 
-    /* release memory for temporary per-frame allocs */
-    for (i = 0; i < thnum; i++)
+#if RT_OPTS_RETAIN != 0
+    if ((opts & RT_OPTS_RETAIN) != 0)
     {
-        tharr[i]->release(tharr[i]->mpool);
+        /* retain lists for the next frame,
+         * released once the scene changes */
+        rcam  = cam;
+        rsimd = pfm->simd;
+
+        pending = 1;
+    }
+    else
+#endif /* RT_OPTS_RETAIN */
+    {
+        /* release memory for temporary per-frame allocs */
+        reset_mpool();
     }
 
-    release(mpool);
-
 #if RT_OPTS_UPDATE_EXT0 != 0
     } /* --<----<-- skip update2 --<----<-- */
     else
@@ -3383,6 +4528,39 @@ rt_void rt_Scene::render(rt_time time)
 #endif /* RT_OPTS_UPDATE_EXT0 */
 }
 
+/*
+ * Release memory for temporary per-frame allocs of the scene and its threads,
+ * grow their pool sizes to the high-water marks of the frame, thus the next
+ * frame's lists fit into chunks retained from this one and release resets
+ * heap pointers without returning chunks to the system heap every frame.
+ */
+rt_void rt_Scene::reset_mpool()
+{
+    rt_si32 i;
+    rt_size size;
+
+    for (i = 0; i < thnum; i++)
+    {
+        if (tharr[i]->mpool == RT_NULL)
+        {
+            continue;
+        }
+
+        /* leave 1/8 headroom for lists growing with camera moves */
+        size = tharr[i]->usage(tharr[i]->mpool);
+        size = RT_MIN(size + size / 8, (rt_size)0x7FFFFFFF);
+        tharr[i]->msize = RT_MAX(tharr[i]->msize, (rt_ui32)size);
+
+        tharr[i]->release(tharr[i]->mpool);
+    }
+
+    size = usage(mpool);
+    size = RT_MIN(size + size / 8, (rt_size)0x7FFFFFFF);
+    msize = RT_MAX(msize, (rt_ui32)size);
+
+    release(mpool);
+}
+
 /*
  * Update portion of the scene with given "index"
  * as part of the multi-threaded update.
@@ -3396,8 +4574,21 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
     rt_Light   *lgt;
     rt_Surface *srf;
 
+#if RT_PROFILE != 0
+    tharr[index]->p_beg[phase] = get_usec();
+#endif /* RT_PROFILE */
+
     if (phase == 1)
     {
+        if (tharr[index]->mpool == RT_NULL)
+        {
+            /* reserve memory for temporary per-frame allocs
+             * from the thread using it, thus its chunks are first
+             * touched (and placed on NUMA-systems) by that thread */
+            tharr[index]->mpool = tharr[index]->reserve(tharr[index]->msize,
+                                                        RT_QUAD_ALIGN);
+        }
+
         for (arr = arr_head, i = 0; arr != RT_NULL; arr = arr->next, i++)
         {
             if ((i % thnum) != index)
@@ -3459,6 +4650,11 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
                 continue;
             }
 
+            /* keep bounding sphere surface's lists were built with,
+             * checked in 3rd phase if lists are rebuilt partially */
+            RT_VEC3_SET(srf->rmid, srf->bvbox->mid);
+            srf->rrad = srf->bvbox->rad;
+
             /* rebuild surface's clip list (cross-surface)
              * based on transform flags updated in 1st phase above */
             tharr[index]->sclip(srf);
@@ -3467,6 +4663,14 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
              * from custom clippers list updated above */
             srf->update_bounds();
 
+#if RT_OPTS_RETAIN != 0
+            /* camera-dependent lists are built in 4th phase */
+            if ((opts & RT_OPTS_RETAIN) != 0)
+            {
+                continue;
+            }
+#endif /* RT_OPTS_RETAIN */
+
             /* rebuild surface's tile list (per-surface)
              * based on surface bounds updated above */
             tharr[index]->stile(srf);
@@ -3489,9 +4693,22 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
 
             /* rebuild surface's rfl/rfr surface lists (cross-surface)
              * based on surface bounds updated in 2nd phase above
-             * and array bounds updated in sequential phase 2.5 */
+             * and array bounds updated in sequential phase 2.5,
+             * also if rebuilt partially as rfl/rfr lists can see
+             * any changed surface, while other surfaces' lists
+             * are pointers to global lists rebuilt above */
             tharr[index]->ssort(srf);
 
+#if RT_OPTS_RETAIN != 0
+            /* keep light/shadow lists retained from previous frame
+             * if they don't depend on surfaces changed in this one */
+            if (rpart && tharr[index]->sdeps(srf) == 0)
+            {
+                pfm->update0(srf->s_srf);
+                continue;
+            }
+#endif /* RT_OPTS_RETAIN */
+
             /* rebuild surface's light/shadow lists (cross-surface)
              * based on surface bounds updated in 2nd phase above
              * and array bounds updated in sequential phase 2.5 */
@@ -3504,7 +4721,132 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
             memset(srf->s_srf->msc_p[0], 255, RT_BUFFER_POOL*thnum);
 #endif /* enable for SIMD-buffers as a debug option if needed */
         }
+
+        /* bin surfaces' tile lists (per-row) into the tilebuffer
+         * based on tile lists built in 2nd phase above
+         * and camera's list built in 7th phase,
+         * camera-dependent tiling is done in 8th phase */
+#if RT_OPTS_RETAIN != 0
+        if ((opts & RT_OPTS_RETAIN) == 0)
+#endif /* RT_OPTS_RETAIN */
+        {
+            tharr[index]->tsort();
+        }
+    }
+    else
+    if (phase == 4)
+    {
+        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* rebuild surface's tile list (per-surface)
+             * based on surface bounds retained from 2nd phase
+             * and camera position updated in 1st phase */
+            tharr[index]->stile(srf);
+        }
+    }
+    else
+    if (phase == 5)
+    {
+        for (i = 0; i < root->obj_num; i++)
+        {
+            if ((i % thnum) != index || !RT_IS_ARRAY(root->obj_arr[i]))
+            {
+                continue;
+            }
+
+            /* update root's sub-array bounds (recursive)
+             * from surface bounds updated in 2nd phase,
+             * sub-arrays are skipped when reduced into root */
+            ((rt_Array *)root->obj_arr[i])->update_bounds();
+        }
+    }
+    else
+    if (phase == 6)
+    {
+        for (srf = srf_head, i = 0; srf != RT_NULL; srf = srf->next, i++)
+        {
+            if ((i % thnum) != index)
+            {
+                continue;
+            }
+
+            /* rebuild surface's node list (per-surface)
+             * based on transform flags and arrays' bounds */
+            tharr[index]->snode(srf);
+        }
+
+        /* rebuild scene's bvh over surfaces
+         * based on surfaces' bounds from 2nd phase,
+         * node lists built above aren't needed inside */
+        if (index == 0)
+        {
+            bvtop = RT_NULL;
+
+#if RT_OPTS_VARRAY_EXT1 != 0
+            if ((opts & RT_OPTS_VARRAY_EXT1) != 0)
+            {
+                bvtop = tharr[index]->bvbuild();
+            }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+        }
+    }
+    else
+    if (phase == 7)
+    {
+        /* rebuild global surface/node list
+         * based on node lists of all surfaces from 6th phase */
+        if (index == 0)
+        {
+            slist = tharr[index]->ssort(RT_NULL);
+            tharr[index]->filter(RT_NULL, &slist);
+
+#if RT_OPTS_VARRAY_EXT1 != 0
+            if ((opts & RT_OPTS_VARRAY_EXT1) != 0)
+            {
+                /* group global surface/node list,
+                 * "bvtop" is needed inside */
+                tharr[index]->bvtree(&slist, RT_NULL);
+            }
+#endif /* RT_OPTS_VARRAY_EXT1 */
+
+            /* rebuild global light/shadow list,
+             * "slist" is needed inside */
+            llist = tharr[index]->lsort(RT_NULL);
+        }
+
+        /* rebuild global hierarchical list
+         * in parallel with the one above */
+        if (index == thnum - 1)
+        {
+            hlist = tharr[index]->ssort(RT_NULL);
+
+#if RT_OPTS_RETAIN != 0
+            if ((opts & RT_OPTS_RETAIN) == 0)
+#endif /* RT_OPTS_RETAIN */
+            {
+                /* rebuild camera's surface/node list,
+                 * "hlist" is needed inside, scene's current
+                 * camera is hidden by the local one above */
+                clist = tharr[index]->ssort(this->cam);
+            }
+        }
     }
+    else
+    if (phase == 8)
+    {
+        /* bin surfaces' tile lists (per-row) into the tilebuffer
+         * based on tile lists built in 4th phase */
+        tharr[index]->tsort();
+    }
+
+#if RT_PROFILE != 0
+    tharr[index]->p_end[phase] = get_usec();
+#endif /* RT_PROFILE */
 }
 
 /*
@@ -3513,10 +4855,15 @@ rt_void rt_Scene::update_slice(rt_si32 index, rt_si32 phase)
  */
 rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
 {
+#if RT_PROFILE != 0
+    tharr[index]->p_beg[RT_PROF_RENDER] = get_usec();
+#endif /* RT_PROFILE */
+
     /* adjust ray steppers according to antialiasing mode */
     rt_real fha[RT_SIMD_WIDTH], fhi[RT_SIMD_WIDTH], fhu; /* h - hor */
     rt_real fva[RT_SIMD_WIDTH], fvi[RT_SIMD_WIDTH], fvu; /* v - ver */
-    rt_si32 i, n;
+    rt_si32 fxi[RT_SIMD_WIDTH], fvo[RT_SIMD_WIDTH], fxu; /* x - idx */
+    rt_si32 i, p, pw, ph;
 
     if (pfm->fsaa == RT_FSAA_NO)
     {
@@ -3526,11 +4873,7 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
             fva[i] = 0.0f;
 
             fhi[i] = (rt_real)i;
-            fvi[i] = (rt_real)index;
         }
-
-        fhu = (rt_real)(pfm->simd_width);
-        fvu = (rt_real)thnum;
     }
     else
     if (pfm->fsaa == RT_FSAA_2X) /* alternating */
@@ -3558,15 +4901,7 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
             fhi[i*4+1] = (rt_real)(i*2+0);
             fhi[i*4+2] = (rt_real)(i*2+1);
             fhi[i*4+3] = (rt_real)(i*2+1);
-
-            fvi[i*4+0] = (rt_real)index;
-            fvi[i*4+1] = (rt_real)index;
-            fvi[i*4+2] = (rt_real)index;
-            fvi[i*4+3] = (rt_real)index;
         }
-
-        fhu = (rt_real)(pfm->simd_width / 2);
-        fvu = (rt_real)thnum;
     }
     else
     if (pfm->fsaa == RT_FSAA_4X)
@@ -3594,15 +4929,7 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
             fhi[i*4+1] = (rt_real)i;
             fhi[i*4+2] = (rt_real)i;
             fhi[i*4+3] = (rt_real)i;
-
-            fvi[i*4+0] = (rt_real)index;
-            fvi[i*4+1] = (rt_real)index;
-            fvi[i*4+2] = (rt_real)index;
-            fvi[i*4+3] = (rt_real)index;
         }
-
-        fhu = (rt_real)(pfm->simd_width / 4);
-        fvu = (rt_real)thnum;
     }
     else
     if (pfm->fsaa == RT_FSAA_8X) /* 8x reserved */
@@ -3610,6 +4937,41 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
         ;
     }
 
+    /* arrange pixels of a SIMD run into a 2D block if packing is enabled,
+     * fall back to scanline runs if block doesn't fit frame's or tile's rows,
+     * samples of a pixel stay adjacent as in scanline runs for AA */
+    pw = pfm->simd_width >> pfm->fsaa;
+    ph = 1;
+
+    if (pfm->pack == RT_PACK_2D)
+    {
+        while (ph * ph * 4 <= pw)
+        {
+            ph *= 2;
+        }
+        if ((y_res % ph) != 0 || (pfm->tile_h % ph) != 0)
+        {
+            ph = 1;
+        }
+    }
+
+    pw /= ph;
+
+    for (i = 0; i < pfm->simd_width; i++)
+    {
+        p = (rt_si32)fhi[i];
+
+        fhi[i] = (rt_real)(p % pw);
+        fvo[i] = p / pw;
+        fvi[i] = (rt_real)(index * ph + fvo[i]);
+
+        fxi[i] = ((p % pw) << pfm->fsaa) + (i & ((1 << pfm->fsaa) - 1));
+    }
+
+    fhu = (rt_real)pw;
+    fvu = (rt_real)(thnum * ph);
+    fxu = pw << pfm->fsaa;
+
 /*  rt_SIMD_CAMERA */
 
     rt_SIMD_CAMERA *s_cam = tharr[index]->s_cam;
@@ -3640,7 +5002,7 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
     RT_SIMD_SET(s_cam->l_amb, amb[RT_A]);
 
     RT_SIMD_SET(s_cam->x_row, (rt_real)(x_row << pfm->fsaa));
-    RT_SIMD_SET(s_cam->idx_h, pfm->simd_width);
+    RT_SIMD_SET(s_cam->idx_h, fxu);
 
 /*  rt_SIMD_CONTEXT */
 
@@ -3662,6 +5024,15 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
     s_inf->cam = s_cam;
     s_inf->lst = clist;
 
+    /* reset occluder cache once lists are built from scratch,
+     * as their addresses used as keys may be reused by new lists,
+     * retained lists keep their addresses and partially rebuilt
+     * ones are allocated on top without releasing the old ones */
+    if (rfull)
+    {
+        memset(s_inf->occ, 0, sizeof(rt_ELEM) * RT_OCC_SLOTS);
+    }
+
     s_inf->thndx = index;
     s_inf->thnum = thnum;
     s_inf->depth = depth;
@@ -3669,15 +5040,89 @@ rt_void rt_Scene::render_slice(rt_si32 index, rt_si32 phase)
 
     s_inf->pt_on = pt_on;
 
+    s_inf->frame = frame;
+
+#if RT_PROFILE != 0
+    s_inf->hmap = hm_on ? hmap : RT_NULL;
+#endif /* RT_PROFILE */
+
+    s_inf->blk_w = pw;
+    s_inf->blk_h = ph;
+
     RT_SIMD_SET(s_inf->pts_c, pts_c);
 
+#if RT_OPTS_THREAD_EXT1 != 0
+    if ((opts & RT_OPTS_THREAD_EXT1) != 0)
+    {
+        rt_SceneThread *thr;
+        rt_si32 j, k, y;
+
+        /* rows of blocks within a job are traversed sequentially */
+        RT_SIMD_SET(s_cam->ver_u, (rt_real)ph);
+
+        s_inf->frm_u = 1;
+
+        /* take tile-row jobs from own queue first,
+         * then steal what is left in other threads' queues */
+        for (k = 0; k < thnum; k++)
+        {
+            thr = tharr[(index + k) % thnum];
+
+            while ((j = RT_ATOMIC_ADD(&thr->jhead, 1)) < thr->jtail)
+            {
+                y = j * pfm->tile_h;
+
+                s_inf->frm_i = y;
+                s_inf->frm_h = RT_MIN(y + pfm->tile_h, y_res);
+
+                for (i = 0; i < pfm->simd_width; i++)
+                {
+                    fvi[i] = (rt_real)(y + fvo[i]);
+                }
+
+                /* path-tracer's sample counter advances in every job */
+                RT_SIMD_SET(s_inf->pts_c, pts_c);
+
+                render_rows(index, fxi, fhi, fvi, fha, fva);
+            }
+        }
+    }
+    else
+#endif /* RT_OPTS_THREAD_EXT1 */
+    {
+        s_inf->frm_i = index * ph;
+        s_inf->frm_u = thnum;
+        s_inf->frm_h = y_res;
+
+        render_rows(index, fxi, fhi, fvi, fha, fva);
+    }
+
+#if RT_PROFILE != 0
+    tharr[index]->p_end[RT_PROF_RENDER] = get_usec();
+#endif /* RT_PROFILE */
+}
+
+/*
+ * Render scanlines set up in thread's backend structures
+ * as a single entry into the backend (per path-tracer pass).
+ */
+rt_void rt_Scene::render_rows(rt_si32 index, rt_si32 *fxi,
+                              rt_real *fhi, rt_real *fvi,
+                              rt_real *fha, rt_real *fva)
+{
+    rt_SIMD_CAMERA  *s_cam = tharr[index]->s_cam;
+    rt_SIMD_CONTEXT *s_ctx = tharr[index]->s_ctx;
+    rt_SIMD_INFOX   *s_inf = tharr[index]->s_inf;
+
+    rt_si32 i, n;
+
     for (n = RT_MAX(1, pt_on); n > 0; n--)
     {
         /* use of integer indices for primary rays update
          * makes related fp-math independent from SIMD width */
         for (i = 0; i < pfm->simd_width; i++)
         {
-            s_cam->index[i] = i;
+            s_cam->index[i] = fxi[i];
             s_inf->hor_c[i] = fhi[i];
 
             s_inf->hor_i[i] = fhi[i];
@@ -3769,6 +5214,115 @@ rt_void rt_Scene::reset_color()
     memset(ptr_b, 0, 4 * x_row * y_res * sizeof(rt_real));
 }
 
+#if RT_PROFILE != 0
+
+/*
+ * Gather profiling data of the last frame
+ * from per-thread timestamps and backend counters.
+ */
+rt_void rt_Scene::profile()
+{
+    rt_si32 i, k;
+    rt_time t_min, t_max, t_phs;
+
+    rt_SceneThread *thr;
+    rt_SIMD_INFOX *s_inf;
+
+    memset(prof.t_idl, 0, sizeof(rt_time) * thnum);
+
+    for (k = 1; k < RT_PROF_PHASES; k++)
+    {
+        t_min = 0;
+        t_max = 0;
+
+        /* phase spans from the first thread to enter
+         * to the last one to leave, skipped phases are 0 */
+        for (i = 0; i < thnum; i++)
+        {
+            thr = tharr[i];
+
+            if (thr->p_end[k] == 0)
+            {
+                continue;
+            }
+
+            t_min = t_min == 0 ? thr->p_beg[k] : RT_MIN(t_min, thr->p_beg[k]);
+            t_max = RT_MAX(t_max, thr->p_end[k]);
+        }
+
+        t_phs = t_max - t_min;
+
+        if (k < RT_PROF_UPDATE)
+        {
+            prof.t_upd[k] = t_phs;
+        }
+        else
+        {
+            prof.t_rnd = t_phs;
+        }
+
+        /* threads wait at the barrier
+         * for the rest of the phase */
+        for (i = 0; i < thnum && t_phs != 0; i++)
+        {
+            thr = tharr[i];
+
+            prof.t_idl[i] += t_phs - (thr->p_end[k] - thr->p_beg[k]);
+        }
+    }
+
+    prof.t_tls = 0;
+
+    prof.n_prm = 0;
+    prof.n_shd = 0;
+    prof.n_rfl = 0;
+    prof.n_rfr = 0;
+    prof.n_pth = 0;
+    prof.n_bvt = 0;
+
+    memset(prof.n_srf, 0, sizeof(prof.n_srf));
+
+    for (i = 0; i < thnum; i++)
+    {
+        thr = tharr[i];
+
+        prof.t_thr[i] = thr->p_end[RT_PROF_RENDER] -
+                        thr->p_beg[RT_PROF_RENDER];
+        prof.t_tls = RT_MAX(prof.t_tls, thr->p_tls);
+
+        /* reset thread's timestamps for the next frame */
+        memset(thr->p_beg, 0, sizeof(thr->p_beg));
+        memset(thr->p_end, 0, sizeof(thr->p_end));
+        thr->p_tls = 0;
+
+        s_inf = thr->s_inf;
+
+        prof.n_prm += s_inf->cnt_prm;
+        prof.n_shd += s_inf->cnt_shd;
+        prof.n_rfl += s_inf->cnt_rfl;
+        prof.n_rfr += s_inf->cnt_rfr;
+        prof.n_pth += s_inf->cnt_pth;
+        prof.n_bvt += s_inf->cnt_bvt;
+
+        for (k = 0; k < RT_TAG_SURFACE_MAX; k++)
+        {
+            prof.n_srf[k] += s_inf->cnt_srf[k];
+        }
+
+        /* reset backend's counters for the next frame */
+        s_inf->cnt_prm = 0;
+        s_inf->cnt_shd = 0;
+        s_inf->cnt_rfl = 0;
+        s_inf->cnt_rfr = 0;
+        s_inf->cnt_pth = 0;
+        s_inf->cnt_bvt = 0;
+
+        memset(s_inf->cnt_srf, 0, sizeof(s_inf->cnt_srf));
+    }
+}
+
+#endif /* RT_PROFILE */
+
 /*
  * Get runtime optimization flags.
  */
@@ -3822,6 +5376,47 @@ rt_si32 rt_Scene::set_pton(rt_si32 pton)
     return this->pt_on;
 }
 
+/*
+ * Get heatmap mode: 0 - off, 1 - elements visited,
+ * 2 - root-solver calls, 3 - ray depth reached per SIMD packet.
+ */
+rt_si32 rt_Scene::get_hmap()
+{
+#if RT_PROFILE != 0
+    return this->hm_on;
+#else /* RT_PROFILE */
+    return 0;
+#endif /* RT_PROFILE */
+}
+
+/*
+ * Set heatmap mode: 0 - off, 1 - elements visited,
+ * 2 - root-solver calls, 3 - ray depth reached per SIMD packet.
+ * Frame's colors are rendered as usual, the heatmap
+ * is exported instead of them by save_frame.
+ */
+rt_si32 rt_Scene::set_hmap(rt_si32 hmap)
+{
+#if RT_PROFILE != 0
+    if (hmap < 0 || hmap > 3)
+    {
+        hmap = 0;
+    }
+
+    if (hmap && !this->hm_on)
+    {
+        memset(this->hmap - (x_row < 0 ? RT_ABS32(x_row) * (y_res - 1) : 0),
+               0, RT_ABS32(x_row) * y_res * sizeof(rt_ui32));
+    }
+
+    this->hm_on = hmap;
+
+    return this->hm_on;
+#else /* RT_PROFILE */
+    return 0;
+#endif /* RT_PROFILE */
+}
+
 /*
  * Return current camera index.
  */
@@ -3857,6 +5452,29 @@ rt_ui32* rt_Scene::get_frame()
     return frame;
 }
 
+/*
+ * Set framebuffer for the next call to render, return it (NULL if not taken).
+ * The application can rotate its own framebuffers this way each frame
+ * (for instance, while the previous one is presented asynchronously),
+ * "frame" is not taken if not SIMD-aligned or if "x_row" doesn't match.
+ */
+rt_ui32* rt_Scene::set_frame(rt_ui32 *frame, rt_si32 x_row)
+{
+    fnext = RT_NULL;
+
+#if (RT_POINTER - RT_ADDRESS) == 0
+
+    if (((rt_word)frame & (RT_SIMD_ALIGN - 1)) == 0 && frame != RT_NULL
+    &&  x_row == this->x_row)
+    {
+        fnext = frame;
+    }
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+    return fnext;
+}
+
 /*
  * Save current frame to an image.
  */
@@ -3894,8 +5512,59 @@ rt_void rt_Scene::save_frame(rt_si32 index)
     tex.x_dim = +x_res;
     tex.y_dim = -y_res;
 
+#if RT_PROFILE != 0
+    rt_ui32 *heat = RT_NULL;
+
+    if (hm_on)
+    {
+        heat = (rt_ui32 *)alloc(x_res * y_res * sizeof(rt_ui32), RT_ALIGN);
+
+        /* cost is stored at the origin of each SIMD packet */
+        rt_si32 pw = (rt_si32)tharr[0]->s_inf->blk_w;
+        rt_si32 ph = (rt_si32)tharr[0]->s_inf->blk_h;
+        rt_si32 sh = (hm_on - 1) * 12, mk = hm_on < 3 ? 0xFFF : 0xFF;
+        rt_si32 i, j, v, m = 1;
+
+        for (j = 0; j < y_res; j += ph)
+        {
+            for (i = 0; i < x_res; i += pw)
+            {
+                v = (hmap[j * x_row + i] >> sh) & mk;
+                m = RT_MAX(m, v);
+            }
+        }
+
+        /* map cost to false colors: blue, cyan, green, yellow, red */
+        for (j = 0; j < y_res; j++)
+        {
+            for (i = 0; i < x_res; i++)
+            {
+                v = (hmap[(j - j % ph) * x_row + (i - i % pw)] >> sh) & mk;
+                v = v * 1020 / m;
+
+                heat[j * x_res + i] =
+                    v < 255 ? 0x0000FF | (v << 8) :
+                    v < 510 ? 0x00FF00 | (510 - v) :
+                    v < 765 ? 0x00FF00 | ((v - 510) << 16) :
+                              0xFF0000 | ((1020 - v) << 8);
+            }
+        }
+
+        tex.ptex = heat;
+        tex.tex_num = +x_res;
+    }
+#endif /* RT_PROFILE */
+
     /* save frame's image */
     save_image(this, name, &tex);
+
+#if RT_PROFILE != 0
+    if (heat != RT_NULL)
+    {
+        /* release memory for temporary heatmap image */
+        release(heat);
+    }
+#endif /* RT_PROFILE */
 }
 
 /*
@@ -3906,6 +5575,19 @@ rt_Platform* rt_Scene::get_platform()
     return pfm;
 }
 
+/*
+ * Return profiling data of the last frame,
+ * NULL if profiling is compiled out.
+ */
+rt_PROFILE* rt_Scene::get_prof()
+{
+#if RT_PROFILE != 0
+    return &prof;
+#else /* RT_PROFILE */
+    return RT_NULL;
+#endif /* RT_PROFILE */
+}
+
 /*
  * Deinitialize scene.
  */
@@ -38,6 +38,9 @@
 #define RT_TILE_W               8  /* screen tile width  in pixels (%S == 0) */
 #define RT_TILE_H               8  /* screen tile height in pixels */
 
+#define RT_BVH_BINS             16 /* number of bins for SAH in scene's bvh */
+#define RT_BVH_LEAF             2  /* max list elements left out of bvh nodes */
+
 /*
  * Floating point thresholds,
  * values have been roughly selected for single-precision,
@@ -58,12 +61,31 @@
 #define RT_FSAA_REGULAR         0 /* makes AA-grid regular if 1 */
 #endif /* RT_FSAA_REGULAR */
 
+/*
+ * SIMD packing modes.
+ */
+#define RT_PACK_NO              0 /* SIMD lanes along a scanline */
+#define RT_PACK_2D              1 /* SIMD lanes in a 2D pixel block */
+
+/*
+ * Profiling phases, update phases keep their numbers,
+ * sequential phase 0.5 is recorded as 0.
+ */
+#define RT_PROF_UPDATE          9 /* update phases 0.5 and 1 to 8 */
+#define RT_PROF_RENDER          9 /* render phase */
+#define RT_PROF_PHASES          10
+
 /* Classes */
 
 class rt_Platform;
 class rt_SceneThread;
 class rt_Scene;
 
+/* Structures */
+
+struct rt_BVNODE;
+struct rt_PROFILE;
+
 /******************************************************************************/
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
@@ -108,6 +130,8 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32             simd;
     /* current antialiasing mode */
     rt_si32             fsaa;
+    /* current SIMD packing mode */
+    rt_si32             pack;
     /* single tile dimensions in pixels */
     rt_si32             tile_w;
     rt_si32             tile_h;
@@ -147,6 +171,8 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     rt_si32     set_fsaa(rt_si32 fsaa);
     rt_si32     get_fsaa_max();
     rt_si32     get_fsaa();
+    rt_si32     set_pack(rt_si32 pack);
+    rt_si32     get_pack();
     rt_si32     get_tile_w();
 
     rt_Scene*   get_cur_scene();
@@ -157,6 +183,78 @@ class rt_Platform : private rt_LogRedirect, public rt_Heap
     friend      class rt_Scene;
 };
 
+/******************************************************************************/
+/**********************************   BVH   ***********************************/
+/******************************************************************************/
+
+/*
+ * Node of the scene's bounding volume hierarchy built over surfaces,
+ * leaves are numbered in tree order for grouping surface lists.
+ */
+struct rt_BVNODE
+{
+    /* node's bbox in world space */
+    rt_vec4             bmin;
+    rt_vec4             bmax;
+
+    /* node's leaf range [lft, rgt),
+     * split at "mdl" between subnodes */
+    rt_si32             lft;
+    rt_si32             mdl;
+    rt_si32             rgt;
+
+    /* subnodes, NULL for leaves */
+    rt_BVNODE          *sub[2];
+
+    /* leaf's surface, NULL for nodes */
+    rt_Surface         *srf;
+
+    /* node's bounding volume for
+     * list elements and backend */
+    rt_BOUND           *box;
+    rt_SIMD_SURFACE    *s_srf;
+};
+
+/******************************************************************************/
+/********************************   PROFILING   *******************************/
+/******************************************************************************/
+
+/*
+ * Profiling counters and timers of the last frame (RT_PROFILE),
+ * times are in microseconds, rays are counted in SIMD packets.
+ */
+struct rt_PROFILE
+{
+    /* wall time per update phase,
+     * [0] is sequential phase 0.5,
+     * [5] to [7] make up phase 2.5,
+     * [8] is tiling with RETAIN */
+    rt_time             t_upd[RT_PROF_UPDATE];
+    /* tile binning time of the slowest thread */
+    rt_time             t_tls;
+    /* wall time of render */
+    rt_time             t_rnd;
+
+    /* per-thread render time and idle time
+     * at barriers of all multi-threaded phases,
+     * arrays hold "thnum" entries */
+    rt_si32             thnum;
+    rt_time            *t_thr;
+    rt_time            *t_idl;
+
+    /* ray packets by kind */
+    rt_ui64             n_prm;
+    rt_ui64             n_shd;
+    rt_ui64             n_rfl;
+    rt_ui64             n_rfr;
+    rt_ui64             n_pth;
+
+    /* bounding volume tests and
+     * root-solver invocations per surface tag */
+    rt_ui64             n_bvt;
+    rt_ui64             n_srf[RT_TAG_SURFACE_MAX];
+};
+
 /******************************************************************************/
 /*********************************   THREAD   *********************************/
 /******************************************************************************/
@@ -192,6 +290,23 @@ class rt_SceneThread : public rt_Heap
      * for temporary per-frame allocs */
     rt_pntr             mpool;
     rt_ui32             msize;
+    /* checkpoint for camera-dependent
+     * allocs when lists are retained */
+    rt_pntr             cpool;
+
+    /* queue of tile-row jobs [jhead, jtail)
+     * shared with other threads for stealing */
+    volatile
+    rt_si32             jhead;
+    rt_si32             jtail;
+
+#if RT_PROFILE != 0
+    /* start and end of each profiling phase,
+     * time spent binning tiles within them */
+    rt_time             p_beg[RT_PROF_PHASES];
+    rt_time             p_end[RT_PROF_PHASES];
+    rt_time             p_tls;
+#endif /* RT_PROFILE */
 
 /*  methods */
 
@@ -201,10 +316,17 @@ class rt_SceneThread : public rt_Heap
 
     rt_ELEM*    insert(rt_Object *obj, rt_ELEM **ptr, rt_ELEM *tem);
 
+    rt_BVNODE*  bvsplit(rt_BVNODE **lfs, rt_si32 lft, rt_si32 rgt);
+    rt_ELEM*    bvlist(rt_BVNODE *nd, rt_ELEM **ptr, rt_si32 num);
+    rt_ELEM*    bvrun(rt_ELEM **ptr, rt_si32 num);
+
     public:
 
     rt_ELEM*    filter(rt_Object *obj, rt_ELEM **ptr);
 
+    rt_BVNODE*  bvbuild();
+    rt_ELEM*    bvtree(rt_ELEM **ptr, rt_ELEM *end);
+
     rt_pntr operator new(size_t size, rt_Heap *hp);
     rt_void operator delete(rt_pntr ptr);
 
@@ -216,9 +338,11 @@ class rt_SceneThread : public rt_Heap
     rt_void     snode(rt_Surface *srf);
     rt_void     sclip(rt_Surface *srf);
     rt_void     stile(rt_Surface *srf);
+    rt_void     tsort();
 
     rt_ELEM*    ssort(rt_Object *obj);
     rt_ELEM*    lsort(rt_Object *obj);
+    rt_si32     sdeps(rt_Surface *srf);
 };
 
 /******************************************************************************/
@@ -248,6 +372,9 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32             x_row;
     rt_ui32            *frame;
 
+    /* framebuffer from set_frame for the next render */
+    rt_ui32            *fnext;
+
     /* tilebuffer's dimensions and pointer */
     rt_si32             tiles_in_row;
     rt_si32             tiles_in_col;
@@ -276,6 +403,27 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_ui32             msize;
     /* pending release flag */
     rt_si32             pending;
+    /* checkpoint for camera-dependent
+     * allocs when lists are retained */
+    rt_pntr             cpool;
+    /* camera and SIMD target
+     * retained lists were built for */
+    rt_Camera          *rcam;
+    rt_si32             rsimd;
+    /* non-zero if retained lists are
+     * rebuilt only for changed surfaces
+     * and surfaces depending on them,
+     * which are linked from "rsrf" */
+    rt_si32             rpart;
+    rt_Surface         *rsrf;
+    /* size of camera-independent lists
+     * built from scratch and with partial
+     * rebuilds on top (incl. replaced) */
+    rt_size             rsize;
+    rt_size             rused;
+    /* non-zero if lists are built
+     * from scratch in current frame */
+    rt_si32             rfull;
 
     /* thread management functions */
     rt_FUNC_UPDATE      f_update;
@@ -295,6 +443,8 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_ELEM            *llist;
     /* camera's surface/node list */
     rt_ELEM            *clist;
+    /* scene's bvh over surfaces */
+    rt_BVNODE          *bvtop;
 
     /* ray-position variables */
     rt_vec4             pos;
@@ -320,11 +470,30 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_Camera          *cam;
     rt_si32             cam_idx;
 
+#if RT_PROFILE != 0
+    /* profiling data of the last frame */
+    rt_PROFILE          prof;
+
+    /* framebuffer's cost-plane for heatmap */
+    rt_ui32            *hmap;
+    rt_si32             hm_on;
+#endif /* RT_PROFILE */
+
 /*  methods */
 
     rt_void     reset_pseed();
     rt_void     reset_color();
 
+    rt_void     reset_mpool();
+
+    rt_void     render_rows(rt_si32 index, rt_si32 *fxi,
+                            rt_real *fhi, rt_real *fvi,
+                            rt_real *fha, rt_real *fva);
+
+#if RT_PROFILE != 0
+    rt_void     profile();
+#endif /* RT_PROFILE */
+
     public:
 
     rt_pntr operator new(size_t size, rt_Heap *hp);
@@ -357,12 +526,17 @@ class rt_Scene : private rt_Registry, public rt_List<rt_Scene>
     rt_si32     set_opts(rt_si32 opts);
     rt_si32     get_pton();
     rt_si32     set_pton(rt_si32 pton);
+    rt_si32     get_hmap();
+    rt_si32     set_hmap(rt_si32 hmap); /* 0 if RT_PROFILE is disabled */
 
     rt_si32     get_cam_idx();
     rt_si32     next_cam();
     rt_ui32*    get_frame();
+    rt_ui32*    set_frame(rt_ui32 *frame, rt_si32 x_row); /* for next render */
     rt_void     save_frame(rt_si32 index);
 
+    rt_PROFILE* get_prof(); /* NULL if RT_PROFILE is disabled */
+
     rt_Platform*get_platform();
 
     friend      class rt_SceneThread;
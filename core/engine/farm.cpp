@@ -0,0 +1,253 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "farm.h"
+
+#if   (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
+
+#include <windows.h>
+
+/*
+ * Allocate memory from system heap (provided by application).
+ */
+rt_pntr sys_alloc(rt_size size);
+
+/*
+ * Free memory from system heap (provided by application).
+ */
+rt_void sys_free(rt_pntr ptr, rt_size size);
+
+/*
+ * Get monotonic time in microseconds.
+ */
+static
+rt_time get_usec()
+{
+    LARGE_INTEGER fr;
+    QueryPerformanceFrequency(&fr);
+    LARGE_INTEGER tm;
+    QueryPerformanceCounter(&tm);
+    return (rt_time)(tm.QuadPart * 1000000 / fr.QuadPart);
+}
+
+#else /* ------------- OS specific ----------------------------------------- */
+
+#include "posix.h"
+
+#endif /* ------------- OS specific ----------------------------------------- */
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * farm.cpp: Implementation of the headless render farm.
+ *
+ * Render farm lets applications embed the engine without a window:
+ * it creates a platform with the internal thread pool (posix.cpp),
+ * or simulates threads with sequential run on Windows (no pool there),
+ * instantiates a scene from its static description (rt_SCENE)
+ * and renders batches of frames for given times and/or cameras
+ * into caller-supplied buffers, returning per-frame render timings.
+ *
+ * Caller's buffers (with row-stride "x_row" in pixels) are rendered to
+ * directly if SIMD-aligned and "x_row" matches the one of the farm,
+ * otherwise the scene's own framebuffer is copied into them after render.
+ * Scene data (rt_SCENE) is locked by one instance at a time, thus
+ * several farms in one application need to render different scenes.
+ */
+
+/******************************************************************************/
+/**********************************   FARM   **********************************/
+/******************************************************************************/
+
+/*
+ * Thread-placement mode of farm's platform,
+ * set ahead of the platform which creates the pool in its constructor.
+ */
+struct rt_FARM_MODE
+{
+    rt_si32             mode;
+
+    rt_FARM_MODE(rt_si32 mode) { this->mode = mode; }
+};
+
+#if   (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
+
+/*
+ * Farm's platform uses engine's sequential run of "thnum" threads,
+ * thread-placement mode is not supported.
+ */
+class rt_FarmPlatform : public rt_FARM_MODE, public rt_Platform
+{
+    public:
+
+    rt_FarmPlatform(rt_si32 mode, rt_si32 thnum) :
+
+        rt_FARM_MODE(mode),
+        rt_Platform(sys_alloc, sys_free, thnum < 0 ? -thnum : 1)
+    {
+
+    }
+};
+
+#else /* ------------- OS specific ----------------------------------------- */
+
+static
+rt_pntr farm_init(rt_si32 thnum, rt_Platform *pfm);
+
+/*
+ * Farm's platform carries thread-placement mode for its own pool,
+ * thus several farms can use different modes.
+ */
+class rt_FarmPlatform : public rt_FARM_MODE, public rt_Platform
+{
+    public:
+
+    rt_FarmPlatform(rt_si32 mode, rt_si32 thnum) :
+
+        rt_FARM_MODE(mode),
+        rt_Platform(sys_alloc, sys_free, thnum,
+                    farm_init, pool_term, pool_update, pool_render)
+    {
+
+    }
+};
+
+/*
+ * Initialize farm's pool of "thnum" threads (< 0 - no feedback).
+ */
+static
+rt_pntr farm_init(rt_si32 thnum, rt_Platform *pfm)
+{
+    return pool_init(thnum, pfm, static_cast<rt_FarmPlatform *>(pfm)->mode);
+}
+
+#endif /* ------------- OS specific ----------------------------------------- */
+
+/*
+ * Instantiate farm for scene "scn" rendered at "x_res" by "y_res",
+ * create "thnum" threads (0 - as many as placement "mode" allows).
+ */
+rt_Farm::rt_Farm(rt_SCENE *scn, rt_si32 x_res, rt_si32 y_res,
+                 rt_si32 thnum, rt_si32 mode)
+{
+    this->x_res = x_res;
+    this->y_res = y_res;
+    this->x_row = (x_res + RT_SIMD_WIDTH - 1) & ~(RT_SIMD_WIDTH - 1);
+
+    pfm = new rt_FarmPlatform(mode, thnum > 0 ? -thnum : RT_THREADS_NUM);
+
+    try
+    {
+        this->scn = new(pfm) rt_Scene(scn, x_res, y_res, x_row, RT_NULL, pfm);
+    }
+    catch (rt_Exception e)
+    {
+        delete pfm;
+        throw;
+    }
+
+    frame = this->scn->get_frame();
+}
+
+/*
+ * Deinitialize farm, its platform destroys the scene.
+ */
+rt_Farm::~rt_Farm()
+{
+    delete pfm;
+}
+
+/*
+ * Render "num" frames at times "time" (or 0 if NULL) with cameras "cam"
+ * (or current if NULL) into buffers "frame" (or none if NULL) of given
+ * row-stride "x_row", store render time in microseconds to "usec" (if not
+ * NULL), return the number of frames rendered.
+ */
+rt_si32 rt_Farm::render(rt_si32 num, rt_time *time, rt_si32 *cam,
+                        rt_ui32 **frame, rt_si32 x_row, rt_time *usec)
+{
+    rt_si32 i, j, k;
+
+    for (i = 0; i < num; i++)
+    {
+        if (cam != RT_NULL)
+        {
+            for (k = scn->get_cam_idx(); scn->get_cam_idx() != cam[i]; )
+            {
+                if (scn->next_cam() == k)
+                {
+                    throw rt_Exception("camera index out of range in render");
+                }
+            }
+        }
+
+        rt_ui32 *fout = frame != RT_NULL ? frame[i] : RT_NULL;
+
+        /* fall back to scene's own framebuffer
+         * if caller's one cannot be rendered to */
+        if (fout == RT_NULL || scn->set_frame(fout, x_row) == RT_NULL)
+        {
+            scn->set_frame(this->frame, this->x_row);
+        }
+
+        rt_time t = get_usec();
+
+        scn->render(time != RT_NULL ? time[i] : 0);
+
+        if (usec != RT_NULL)
+        {
+            usec[i] = get_usec() - t;
+        }
+
+        rt_ui32 *fsrc = scn->get_frame();
+
+        if (fout == RT_NULL || fout == fsrc)
+        {
+            continue;
+        }
+
+        for (j = 0; j < y_res; j++)
+        {
+            memcpy(fout + j * x_row, fsrc + j * this->x_row,
+                   sizeof(rt_ui32) * x_res);
+        }
+    }
+
+    return num;
+}
+
+/*
+ * Return row-stride (in pixels) of farm's framebuffers,
+ * caller's buffers with this stride are rendered to directly.
+ */
+rt_si32 rt_Farm::get_x_row()
+{
+    return x_row;
+}
+
+/*
+ * Return farm's scene (for instance, to change its options).
+ */
+rt_Scene* rt_Farm::get_scene()
+{
+    return scn;
+}
+
+/*
+ * Return farm's platform (for instance, to change SIMD or AA modes).
+ */
+rt_Platform* rt_Farm::get_platform()
+{
+    return pfm;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
@@ -0,0 +1,79 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#ifndef RT_FARM_H
+#define RT_FARM_H
+
+#include "engine.h"
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * farm.h: Interface for the headless render farm.
+ *
+ * More detailed description of this subsystem is given in farm.cpp.
+ * Recommended naming scheme for C++ types and definitions is given in rtbase.h.
+ */
+
+/******************************************************************************/
+/*******************************   DEFINITIONS   ******************************/
+/******************************************************************************/
+
+/* Classes */
+
+class rt_Farm;
+
+/******************************************************************************/
+/**********************************   FARM   **********************************/
+/******************************************************************************/
+
+/*
+ * Farm renders batches of frames of a given scene to memory without a window,
+ * using its own platform with the internal thread pool from posix.h
+ * (or sequential run of threads on Windows).
+ */
+class rt_Farm
+{
+/*  fields */
+
+    private:
+
+    /* platform with the scene */
+    rt_Platform        *pfm;
+    rt_Scene           *scn;
+
+    /* scene's own framebuffer */
+    rt_si32             x_res;
+    rt_si32             y_res;
+    rt_si32             x_row;
+    rt_ui32            *frame;
+
+/*  methods */
+
+    public:
+
+    rt_Farm(rt_SCENE *scn, rt_si32 x_res, rt_si32 y_res,
+            rt_si32 thnum = 0,  /* 0 - per placement "mode", else exact */
+            rt_si32 mode = 1);  /* 1 - per cpu, 2 - per core, 3 - per L3 */
+
+    virtual
+   ~rt_Farm();
+
+    rt_si32     render(rt_si32 num, rt_time *time, rt_si32 *cam,
+                       rt_ui32 **frame, rt_si32 x_row, rt_time *usec);
+
+    rt_si32     get_x_row();
+    rt_Scene*   get_scene();
+    rt_Platform*get_platform();
+};
+
+#endif /* RT_FARM_H */
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
@@ -42,7 +42,8 @@
 #define RT_OPTS_TILING_EXT1     (1 << 2)
 #define RT_OPTS_FSCALE          (1 << 3)
 #define RT_OPTS_TARRAY          (1 << 4)
-#define RT_OPTS_VARRAY          (1 << 5) /* 6 is reserved for future exts */
+#define RT_OPTS_VARRAY          (1 << 5)
+#define RT_OPTS_VARRAY_EXT1     (1 << 6) /* SAH-built bvh over surfaces */
 #define RT_OPTS_ADJUST          (1 << 7)
 #define RT_OPTS_UPDATE          (1 << 8)
 #define RT_OPTS_RENDER          (1 << 9)
@@ -60,6 +61,9 @@
 #define RT_OPTS_GAMMA           (1 << 20) /* turns off Gamma when set to 1 */
 #define RT_OPTS_FRESNEL         (1 << 21) /* turns off Fresnel when set to 1 */
 
+#define RT_OPTS_THREAD_EXT1     (1 << 22) /* tile-row jobs with work-stealing */
+#define RT_OPTS_RETAIN          (1 << 23) /* retains lists of static frames */
+
 #define RT_OPTS_BUFFERS         (0 << 24) /* prohibits SIMD-buffers if 1 */
 #define RT_OPTS_PT              (1 << 25) /* prohibits path-tracer if 1 */
 
@@ -86,11 +90,13 @@
 
 #define RT_OPTS_FULL            (                                           \
         RT_OPTS_THREAD          |                                           \
+        RT_OPTS_THREAD_EXT1     |                                           \
         RT_OPTS_TILING          |                                           \
         RT_OPTS_TILING_EXT1     |                                           \
         RT_OPTS_FSCALE          |                                           \
         RT_OPTS_TARRAY          |                                           \
         RT_OPTS_VARRAY          |                                           \
+        RT_OPTS_VARRAY_EXT1     |                                           \
         RT_OPTS_ADJUST          |                                           \
         RT_OPTS_UPDATE          |                                           \
         RT_OPTS_RENDER          |                                           \
@@ -104,6 +110,7 @@
         RT_OPTS_INSERT_EXT1     |                                           \
         RT_OPTS_INSERT_EXT2     |                                           \
         RT_OPTS_REMOVE          |                                           \
+        RT_OPTS_RETAIN          |                                           \
         RT_OPTS_GAMMA           |                                           \
         RT_OPTS_FRESNEL         |                                           \
         RT_OPTS_BUFFERS         |                                           \
@@ -129,7 +136,8 @@
 #define RT_TAG_PARACYLINDER                 6
 #define RT_TAG_HYPERCYLINDER                7
 #define RT_TAG_HYPERPARABOLOID              8
-#define RT_TAG_SURFACE_MAX                  9
+#define RT_TAG_MESH                         9
+#define RT_TAG_SURFACE_MAX                 10
 
 /* special tags */
 #define RT_TAG_CAMERA                       100
@@ -155,6 +163,9 @@
 #define RT_IS_PLANE(o)                                                      \
         ((o)->tag == RT_TAG_PLANE)
 
+#define RT_IS_MESH(o)                                                       \
+        ((o)->tag == RT_TAG_MESH)
+
 /******************************************************************************/
 /********************************   RELATION   ********************************/
 /******************************************************************************/
@@ -427,6 +438,11 @@ rt_si32 CM_(rt_CAMERA *pobj)
 
 #define RT_LGT(tag)                         RT_LGT_##tag
 
+/*
+ * Attenuation properties are: rng, cnt, lnr, qdr, where range (rng)
+ * limits the set of surfaces lit by the light, if 0 it is derived from
+ * source intensity and attenuation, if negative range is not limited.
+ */
 struct rt_LIGHT
 {
     rt_si32             tag;
@@ -752,6 +768,47 @@ rt_si32 HP_(rt_HYPERPARABOLOID *pobj)
     pmat_outer,             pmat_inner                                      \
 }
 
+/******************************************************************************/
+/**********************************   MESH   **********************************/
+/******************************************************************************/
+
+/*
+ * Triangle mesh in object's local space, outer side is the one from which
+ * the triangle's vertices are seen in counter-clockwise order (as for
+ * right-handed coords), min/max of the surface clip the mesh as a whole.
+ * Meshes are not supported as custom clippers (ignored in the backend).
+ */
+struct rt_MESH
+{
+    rt_SURFACE          srf;
+    rt_vec3            *vrt;    /* vertex buffer */
+    rt_si32             vrt_num;
+    rt_si32            *idx;    /* index buffer, 3 indices per triangle */
+    rt_si32             tri_num;
+};
+
+static /* needed for strict typization */
+rt_si32 MS_(rt_MESH *pobj)
+{
+    return RT_TAG_MESH;
+}
+
+#define RT_OBJ_MESH(pobj)                                                   \
+{                                                                           \
+    MS_(pobj),                                                              \
+    pobj,                   1,                                              \
+    RT_NULL,                0,                                              \
+    RT_NULL,                RT_NULL                                         \
+}
+
+#define RT_OBJ_MESH_MAT(pobj, pmat_outer, pmat_inner)                       \
+{                                                                           \
+    MS_(pobj),                                                              \
+    pobj,                   1,                                              \
+    RT_NULL,                0,                                              \
+    pmat_outer,             pmat_inner                                      \
+}
+
 /******************************************************************************/
 /**********************************   SCENE   *********************************/
 /******************************************************************************/
@@ -603,6 +603,40 @@ rt_Light::rt_Light(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj) :
         lgt->col.hdr[RT_B] = ((lgt->col.val >> 0x00) & 0xFF) / 255.0f;
     }
 
+    /* derive effective range from source intensity and attenuation
+     * unless given explicitly (rng > 0) or disabled (rng < 0),
+     * which is the distance where intensity falls below threshold:
+     * lum / sqrt(qdr * r^2 + lnr * r + cnt) < RT_LGHT_THRESHOLD */
+    rt_real qdr = lgt->atn[3], lnr = lgt->atn[2], cnt = lgt->atn[1] + 1.0f;
+    rt_real lim = lgt->lum[1] / RT_LGHT_THRESHOLD;
+
+    /* solve qdr * r^2 + lnr * r = lim^2 - cnt */
+    lim = lim * lim - cnt;
+
+    if (lgt->atn[0] > 0.0f)
+    {
+        rng = lgt->atn[0];
+    }
+    else
+    if (lgt->atn[0] < 0.0f || (qdr <= 0.0f && lnr <= 0.0f))
+    {
+        rng = RT_INF;
+    }
+    else
+    if (lim <= 0.0f)
+    {
+        rng = 0.0f;
+    }
+    else
+    if (qdr <= 0.0f)
+    {
+        rng = lim / lnr;
+    }
+    else
+    {
+        rng = (RT_SQRT(lnr * lnr + 4.0f * qdr * lim) - lnr) / (2.0f * qdr);
+    }
+
 /*  rt_SIMD_LIGHT */
 
     s_lgt = (rt_SIMD_LIGHT *)rg->alloc(sizeof(rt_SIMD_LIGHT), RT_SIMD_ALIGN);
@@ -1337,6 +1371,10 @@ rt_Array::rt_Array(rt_Registry *rg, rt_Object *parent,
             obj_arr[j] = new(rg) rt_HyperParaboloid(rg, this, &arr[i]);
             break;
 
+            case RT_TAG_MESH:
+            obj_arr[j] = new(rg) rt_Mesh(rg, this, &arr[i]);
+            break;
+
             default:
             j--;
             obj_num--;
@@ -2338,6 +2376,11 @@ rt_void rt_Array::update_bounds()
     {
         update_bbgeom(trbox);
     }
+
+    /* reset array's changed status once bounds are updated,
+     * thus sub-arrays updated in multi-threaded phase
+     * are skipped when reduced into parent array */
+    arr_changed = 0;
 }
 
 /*
@@ -2376,6 +2419,11 @@ rt_Surface::rt_Surface(rt_Registry *rg, rt_Object *parent,
     /* reset surface's changed status */
     srf_changed = 0;
 
+    /* reset state for retained lists */
+    RT_VEC3_SET_VAL1(rmid, 0.0f);
+    rrad = 0.0f;
+    rnxt = RT_NULL;
+
     /* init outer side material */
     outer = new(rg) rt_Material(rg, &srf->side_outer,
                     obj->obj.pmat_outer ? obj->obj.pmat_outer :
@@ -2399,6 +2447,28 @@ rt_Surface::rt_Surface(rt_Registry *rg, rt_Object *parent,
     s_srf->mat_p[1] = (rt_pntr)(rt_word)outer->props;
     s_srf->mat_p[2] = inner->s_mat;
     s_srf->mat_p[3] = (rt_pntr)(rt_word)inner->props;
+
+/*  rt_SIMD_SURFACE */
+
+    /* bvbox's bounding sphere is always in world space,
+     * thus no axis mapping or transform is needed */
+    s_bvb = (rt_SIMD_SURFACE *)rg->alloc(sizeof(rt_SIMD_SURFACE),
+                                                            RT_SIMD_ALIGN);
+    memset(s_bvb, 0, sizeof(rt_SIMD_SURFACE));
+    s_bvb->srf_t[3] = RT_TAG_SURFACE_MAX;
+
+    s_bvb->mat_p[0] = outer->s_mat;
+    s_bvb->mat_p[1] = (rt_pntr)(rt_word)outer->props;
+    s_bvb->mat_p[2] = inner->s_mat;
+    s_bvb->mat_p[3] = (rt_pntr)(rt_word)inner->props;
+
+    s_bvb->a_map[RT_I] = RT_X * RT_SIMD_QUADS * 16;
+    s_bvb->a_map[RT_J] = RT_Y * RT_SIMD_QUADS * 16;
+    s_bvb->a_map[RT_K] = RT_Z * RT_SIMD_QUADS * 16;
+    s_bvb->a_map[RT_L] = 0;
+
+    RT_SIMD_SET(s_bvb->d_eps, RT_DEPS_THRESHOLD);
+    RT_SIMD_SET(s_bvb->t_eps, RT_TEPS_THRESHOLD);
 }
 
 /*
@@ -2847,6 +2917,15 @@ rt_void rt_Surface::update_bounds()
     if (bvbox->verts_num != 0)
     {
         update_bbgeom(bvbox);
+
+        RT_SIMD_SET(s_bvb->pos_x, bvbox->mid[RT_X]);
+        RT_SIMD_SET(s_bvb->pos_y, bvbox->mid[RT_Y]);
+        RT_SIMD_SET(s_bvb->pos_z, bvbox->mid[RT_Z]);
+
+        RT_SIMD_SET(s_bvb->sci_w, bvbox->rad * bvbox->rad);
+        RT_SIMD_SET(s_bvb->sci_x, 1.0f);
+        RT_SIMD_SET(s_bvb->sci_y, 1.0f);
+        RT_SIMD_SET(s_bvb->sci_z, 1.0f);
     }
 
     s_srf->min_t[RT_X] = shape->cmin[RT_X] == -RT_INF ? 0 : 1;
@@ -3980,6 +4059,366 @@ rt_HyperParaboloid::~rt_HyperParaboloid()
 
 }
 
+/******************************************************************************/
+/**********************************   MESH   **********************************/
+/******************************************************************************/
+
+/*
+ * Compute triangle's "t" centroid along axis "k" (scaled by 3).
+ */
+static
+rt_real mesh_mid(rt_MESH *xms, rt_si32 t, rt_si32 k)
+{
+    rt_si32 *tri = &xms->idx[t * 3];
+
+    return xms->vrt[tri[0]][k] + xms->vrt[tri[1]][k] + xms->vrt[tri[2]][k];
+}
+
+/*
+ * Instantiate mesh surface object.
+ */
+rt_Mesh::rt_Mesh(rt_Registry *rg, rt_Object *parent,
+                 rt_OBJECT *obj, rt_si32 ssize) :
+
+    rt_Surface(rg, parent, obj, ssize)
+{
+    xms = (rt_MESH *)obj->obj.pobj;
+
+    rt_si32 i, n = xms->tri_num;
+
+    if (xms->vrt == RT_NULL || xms->idx == RT_NULL || n <= 0)
+    {
+        throw rt_Exception("mesh has no triangles");
+    }
+
+    for (i = 0; i < n * 3; i++)
+    {
+        if (xms->idx[i] < 0 || xms->idx[i] >= xms->vrt_num)
+        {
+            throw rt_Exception("mesh index out of range");
+        }
+    }
+
+    /* init surface's bvbox used for tiling, rtgeom and array's bounds */
+    if (RT_TRUE)
+    {
+        bvbox->verts_num = 8;
+        bvbox->verts = (rt_VERT *)
+                     rg->alloc(bvbox->verts_num * sizeof(rt_VERT), RT_ALIGN);
+
+        bvbox->edges_num = RT_ARR_SIZE(bx_edges);
+        bvbox->edges = (rt_EDGE *)
+                     rg->alloc(bvbox->edges_num * sizeof(rt_EDGE), RT_ALIGN);
+        memcpy(bvbox->edges, bx_edges, bvbox->edges_num * sizeof(rt_EDGE));
+
+        bvbox->faces_num = RT_ARR_SIZE(bx_faces);
+        bvbox->faces = (rt_FACE *)
+                     rg->alloc(bvbox->faces_num * sizeof(rt_FACE), RT_ALIGN);
+        memcpy(bvbox->faces, bx_faces, bvbox->faces_num * sizeof(rt_FACE));
+    }
+
+    /* build mesh's bvh in local space once,
+     * binary tree with leaves of at least 1 triangle
+     * has no more than 2 * n - 1 nodes */
+    tri_ord = (rt_si32 *)rg->alloc(n * sizeof(rt_si32), RT_ALIGN);
+    nod_box = (rt_real *)rg->alloc((2 * n - 1) * 6 * sizeof(rt_real), RT_ALIGN);
+    nod_idx = (rt_si32 *)rg->alloc((2 * n - 1) * 3 * sizeof(rt_si32), RT_ALIGN);
+    nod_num = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        tri_ord[i] = i;
+    }
+
+    build_node(0, n);
+
+/*  rt_SIMD_MESHNODE, rt_SIMD_MESHTRI */
+
+    s_nod = (rt_SIMD_MESHNODE *)rg->alloc(nod_num * sizeof(rt_SIMD_MESHNODE),
+                                                            RT_SIMD_ALIGN);
+    memset(s_nod, 0, nod_num * sizeof(rt_SIMD_MESHNODE));
+
+    s_tri = (rt_SIMD_MESHTRI *)rg->alloc(n * sizeof(rt_SIMD_MESHTRI),
+                                                            RT_SIMD_ALIGN);
+    memset(s_tri, 0, n * sizeof(rt_SIMD_MESHTRI));
+
+    /* bvh topology doesn't change after build,
+     * leaves continue with their skip pointers */
+    for (i = 0; i < nod_num; i++)
+    {
+        rt_si32 *idx = &nod_idx[i * 3];
+
+        s_nod[i].nxt_p[1] = idx[0] < nod_num ? &s_nod[idx[0]] : RT_NULL;
+
+        if (idx[1] < idx[2])
+        {
+            s_nod[i].nxt_p[0] = s_nod[i].nxt_p[1];
+
+            s_nod[i].tri_p[0] = &s_tri[idx[1]];
+            s_nod[i].tri_p[1] = &s_tri[idx[2]];
+        }
+        else
+        {
+            s_nod[i].nxt_p[0] = &s_nod[i + 1];
+        }
+    }
+
+/*  rt_SIMD_SURFACE */
+
+    s_srf->msh_p[0] = s_nod;
+}
+
+/*
+ * Build bvh node (and its sub-tree) for triangles from "lo" to "hi"
+ * in bvh order, nodes are allocated depth-first.
+ */
+rt_void rt_Mesh::build_node(rt_si32 lo, rt_si32 hi)
+{
+    rt_si32 i, j, k, n = nod_num++;
+
+    rt_real *bmin = &nod_box[n * 6 + 0];
+    rt_real *bmax = &nod_box[n * 6 + 3];
+    rt_si32 *idx  = &nod_idx[n * 3];
+
+    rt_vec4 cmin, cmax;
+
+    RT_VEC3_SET_VAL1(bmin, +RT_INF);
+    RT_VEC3_SET_VAL1(bmax, -RT_INF);
+
+    RT_VEC3_SET_VAL1(cmin, +RT_INF);
+    RT_VEC3_SET_VAL1(cmax, -RT_INF);
+
+    for (i = lo; i < hi; i++)
+    {
+        rt_si32 *tri = &xms->idx[tri_ord[i] * 3];
+
+        for (k = 0; k < 3; k++)
+        {
+            for (j = 0; j < 3; j++)
+            {
+                bmin[k] = RT_MIN(bmin[k], xms->vrt[tri[j]][k]);
+                bmax[k] = RT_MAX(bmax[k], xms->vrt[tri[j]][k]);
+            }
+
+            cmin[k] = RT_MIN(cmin[k], mesh_mid(xms, tri_ord[i], k));
+            cmax[k] = RT_MAX(cmax[k], mesh_mid(xms, tri_ord[i], k));
+        }
+    }
+
+    idx[1] = 0;
+    idx[2] = 0;
+
+    if (hi - lo <= RT_MESH_LEAF)
+    {
+        idx[0] = nod_num;
+        idx[1] = lo;
+        idx[2] = hi;
+        return;
+    }
+
+    /* split triangles at the median of their centroids
+     * along the longest axis of centroids' bounds */
+    k = cmax[RT_X] - cmin[RT_X] >= cmax[RT_Y] - cmin[RT_Y] ? RT_X : RT_Y;
+    k = cmax[k] - cmin[k] >= cmax[RT_Z] - cmin[RT_Z] ? k : RT_Z;
+
+    rt_si32 mid = (lo + hi) / 2, l = lo, r = hi - 1, t;
+
+    while (l < r)
+    {
+        rt_real p = mesh_mid(xms, tri_ord[(l + r) / 2], k);
+
+        for (i = l, j = r; i <= j; )
+        {
+            while (mesh_mid(xms, tri_ord[i], k) < p)
+            {
+                i++;
+            }
+            while (mesh_mid(xms, tri_ord[j], k) > p)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                t = tri_ord[i];
+                tri_ord[i++] = tri_ord[j];
+                tri_ord[j--] = t;
+            }
+        }
+
+        if (mid <= j)
+        {
+            r = j;
+        }
+        else
+        if (mid >= i)
+        {
+            l = i;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    build_node(lo, mid);
+    build_node(mid, hi);
+
+    idx[0] = nod_num;
+}
+
+/*
+ * Update SIMD and other data fields.
+ */
+rt_void rt_Mesh::update_fields()
+{
+    if (obj_changed == 0)
+    {
+        return;
+    }
+
+    rt_Surface::update_fields();
+
+    /* map local space bvh to backend's space of the surface,
+     * normals are mapped with inverted scalers to remain orthogonal */
+    rt_si32 i, k, m[3];
+    rt_real f[3], ext = 0.0f;
+
+    m[RT_I] = mp_i;
+    m[RT_J] = mp_j;
+    m[RT_K] = mp_k;
+
+    f[RT_I] = sgn[RT_I] * scl[mp_i];
+    f[RT_J] = sgn[RT_J] * scl[mp_j];
+    f[RT_K] = sgn[RT_K] * scl[mp_k];
+
+    for (k = 0; k < nod_num; k++)
+    {
+        rt_real *box = &nod_box[k * 6];
+        rt_vec4 bmin, bmax;
+
+        for (i = 0; i < 3; i++)
+        {
+            bmin[m[i]] = RT_MIN(box[i + 0] * f[i], box[i + 3] * f[i]);
+            bmax[m[i]] = RT_MAX(box[i + 0] * f[i], box[i + 3] * f[i]);
+
+            ext = RT_MAX(ext, bmax[m[i]] - bmin[m[i]]);
+        }
+
+        RT_SIMD_SET(s_nod[k].min_x, bmin[RT_X]);
+        RT_SIMD_SET(s_nod[k].min_y, bmin[RT_Y]);
+        RT_SIMD_SET(s_nod[k].min_z, bmin[RT_Z]);
+
+        RT_SIMD_SET(s_nod[k].max_x, bmax[RT_X]);
+        RT_SIMD_SET(s_nod[k].max_y, bmax[RT_Y]);
+        RT_SIMD_SET(s_nod[k].max_z, bmax[RT_Z]);
+    }
+
+    for (k = 0; k < xms->tri_num; k++)
+    {
+        rt_si32 *tri = &xms->idx[tri_ord[k] * 3];
+        rt_real *v0 = xms->vrt[tri[0]];
+        rt_real *v1 = xms->vrt[tri[1]];
+        rt_real *v2 = xms->vrt[tri[2]];
+
+        rt_vec4 ea, eb, nl, vp, ep, fp, np;
+
+        RT_VEC3_SUB(ea, v1, v0);
+        RT_VEC3_SUB(eb, v2, v0);
+
+        nl[RT_I] = ea[RT_J] * eb[RT_K] - ea[RT_K] * eb[RT_J];
+        nl[RT_J] = ea[RT_K] * eb[RT_I] - ea[RT_I] * eb[RT_K];
+        nl[RT_K] = ea[RT_I] * eb[RT_J] - ea[RT_J] * eb[RT_I];
+
+        for (i = 0; i < 3; i++)
+        {
+            vp[m[i]] = v0[i] * f[i];
+            ep[m[i]] = ea[i] * f[i];
+            fp[m[i]] = eb[i] * f[i];
+            np[m[i]] = nl[i] / f[i];
+        }
+
+        rt_real len = RT_VEC3_LEN(np);
+        len = len > 0.0f ? 1.0f / len : 0.0f;
+
+        RT_SIMD_SET(s_tri[k].ver_x, vp[RT_X]);
+        RT_SIMD_SET(s_tri[k].ver_y, vp[RT_Y]);
+        RT_SIMD_SET(s_tri[k].ver_z, vp[RT_Z]);
+
+        RT_SIMD_SET(s_tri[k].e_1_x, ep[RT_X]);
+        RT_SIMD_SET(s_tri[k].e_1_y, ep[RT_Y]);
+        RT_SIMD_SET(s_tri[k].e_1_z, ep[RT_Z]);
+
+        RT_SIMD_SET(s_tri[k].e_2_x, fp[RT_X]);
+        RT_SIMD_SET(s_tri[k].e_2_y, fp[RT_Y]);
+        RT_SIMD_SET(s_tri[k].e_2_z, fp[RT_Z]);
+
+        RT_SIMD_SET(s_tri[k].nrm_x, np[RT_X] * len);
+        RT_SIMD_SET(s_tri[k].nrm_y, np[RT_Y] * len);
+        RT_SIMD_SET(s_tri[k].nrm_z, np[RT_Z] * len);
+    }
+
+    /* self-hit threshold for secondary rays
+     * scales with mesh size in backend's space */
+    RT_SIMD_SET(s_srf->t_eps, RT_MAX(ext * RT_MESH_THRESHOLD,
+                                     RT_TEPS_THRESHOLD));
+
+    /* set surface shape,
+     * mesh has no analytic shape for rtgeom */
+
+    RT_VEC3_SET_VAL1(shape->sci, 0.0f);
+    shape->sci[RT_W] = 0.0f;
+
+    RT_VEC3_SET_VAL1(shape->scj, 0.0f);
+    shape->scj[RT_W] = 0.0f;
+
+    RT_VEC3_SET_VAL1(shape->sck, 0.0f);
+    shape->sck[RT_W] = 0.0f;
+}
+
+/*
+ * Adjust local space bounding and clipping boxes according to surface shape.
+ */
+rt_void rt_Mesh::adjust_minmax(rt_vec4 smin, rt_vec4 smax, /* src */
+                               rt_vec4 bmin, rt_vec4 bmax, /* bbox */
+                               rt_vec4 cmin, rt_vec4 cmax) /* cbox */
+{
+    rt_Surface::adjust_minmax(smin, smax, bmin, bmax, cmin, cmax);
+
+    /* mesh's local bounds are the bounds of bvh's root */
+    rt_real *vmin = &nod_box[0];
+    rt_real *vmax = &nod_box[3];
+
+    if (cmin != RT_NULL && cmax != RT_NULL)
+    {
+        cmin[RT_I] = cmin[RT_I] <= vmin[RT_I] ? -RT_INF : cmin[RT_I];
+        cmin[RT_J] = cmin[RT_J] <= vmin[RT_J] ? -RT_INF : cmin[RT_J];
+        cmin[RT_K] = cmin[RT_K] <= vmin[RT_K] ? -RT_INF : cmin[RT_K];
+
+        cmax[RT_I] = cmax[RT_I] >= vmax[RT_I] ? +RT_INF : cmax[RT_I];
+        cmax[RT_J] = cmax[RT_J] >= vmax[RT_J] ? +RT_INF : cmax[RT_J];
+        cmax[RT_K] = cmax[RT_K] >= vmax[RT_K] ? +RT_INF : cmax[RT_K];
+    }
+
+    if (bmin != RT_NULL && bmax != RT_NULL)
+    {
+        bmin[RT_I] = RT_MAX(smin[RT_I], vmin[RT_I]);
+        bmin[RT_J] = RT_MAX(smin[RT_J], vmin[RT_J]);
+        bmin[RT_K] = RT_MAX(smin[RT_K], vmin[RT_K]);
+
+        bmax[RT_I] = RT_MIN(smax[RT_I], vmax[RT_I]);
+        bmax[RT_J] = RT_MIN(smax[RT_J], vmax[RT_J]);
+        bmax[RT_K] = RT_MIN(smax[RT_K], vmax[RT_K]);
+    }
+}
+
+/*
+ * Deinitialize mesh surface object.
+ */
+rt_Mesh::~rt_Mesh()
+{
+
+}
+
 /******************************************************************************/
 /********************************   MATERIAL   ********************************/
 /******************************************************************************/
@@ -4055,7 +4494,7 @@ rt_Material::rt_Material(rt_Registry *rg, rt_SIDE *sd, rt_MATERIAL *mat) :
     /* save original texture data */
     if ((tx->x_dim == 0 && tx->y_dim == 0)
 #if (RT_POINTER - RT_ADDRESS) != 0
-    || (rt_full)tx->ptex >= (rt_full)(0x80000000 - tx->x_dim * tx->y_dim * 4)
+    || (rt_full)tx->ptex >= RT_ADDRESS_TOP - tx->x_dim * tx->y_dim * 4
 #endif /* (RT_POINTER - RT_ADDRESS) */
        )
     {
@@ -4231,14 +4670,14 @@ rt_void rt_Material::resolve_texture(rt_Registry *rg)
 
 #if (RT_POINTER - RT_ADDRESS) != 0
 
-    if ((rt_full)tx->ptex >= (rt_full)(0x80000000 - tx->x_dim * tx->y_dim * 4))
+    if ((rt_full)tx->ptex >= RT_ADDRESS_TOP - tx->x_dim * tx->y_dim * 4)
     {
         rt_pntr pnew = rg->alloc(tx->x_dim * tx->y_dim * 4, RT_ALIGN);
         memcpy(pnew, tx->ptex, tx->x_dim * tx->y_dim * 4);
         tx->ptex = pnew;
     }
 
-    if ((rt_full)tx->ptex >= (rt_full)(0x80000000 - tx->x_dim * tx->y_dim * 4))
+    if ((rt_full)tx->ptex >= RT_ADDRESS_TOP - tx->x_dim * tx->y_dim * 4)
     {
         throw rt_Exception("address exceeded allowed range in material");
     }
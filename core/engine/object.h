@@ -41,6 +41,15 @@
 #define RT_DEPS_THRESHOLD       0.00000000001f /* <- maximum for two-plane */
 #define RT_TEPS_THRESHOLD       0.0000001f /* <- minimum for roots sorting */
 
+#define RT_MESH_THRESHOLD       0.00001f /* <- self-hit range per mesh size */
+
+/*
+ * Mesh bvh limits.
+ */
+#define RT_MESH_LEAF            4  /* maximum number of triangles per leaf */
+
+#define RT_LGHT_THRESHOLD       0.002f /* <- intensity at lgt's derived range */
+
 /*
  * Camera actions.
  */
@@ -102,6 +111,7 @@ class rt_Hyperboloid;
 class rt_ParaCylinder;
 class rt_HyperCylinder;
 class rt_HyperParaboloid;
+class rt_Mesh;
 
 class rt_Texture;
 class rt_Material;
@@ -365,6 +375,10 @@ class rt_Light : public rt_Object, public rt_List<rt_Light>
 
     rt_LIGHT           *lgt;
 
+    /* effective range,
+     * RT_INF if not limited */
+    rt_real             rng;
+
     rt_SIMD_LIGHT      *s_lgt;
 
 /*  methods */
@@ -541,11 +555,20 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
 
     rt_SURFACE         *srf;
 
+    public:
+
     /* non-zero if surface itself or
      * some of its clippers changed */
     rt_si32             srf_changed;
 
-    public:
+    /* bounding sphere retained lists
+     * were built with (RT_OPTS_RETAIN) */
+    rt_vec4             rmid;
+    rt_real             rrad;
+
+    /* next surface changed in the frame
+     * with retained lists rebuilt partially */
+    rt_Surface         *rnxt;
 
     /* top of the trnode/bvnode
      * sequence on the branch */
@@ -555,14 +578,26 @@ class rt_Surface : public rt_Node, public rt_List<rt_Surface>
      * where bvnode is not allowed */
     rt_ELEM            *trn;
 
-    /* tiles list in framebuffer
-     * prepared for rendering */
-    rt_ELEM            *tls;
+    /* tiles lists in framebuffer
+     * prepared for rendering,
+     * one list per tile row
+     * for "tlh" rows from "tly" */
+    rt_ELEM           **tls;
+    rt_si32             tly;
+    rt_si32             tlh;
+
+    /* leaf index in scene's bvh,
+     * negative if not in the bvh */
+    rt_si32             bvi;
 
     /* surface shape extension to
      * bounding box and volume */
     rt_SHAPE           *shape;
 
+    /* surface SIMD struct,
+     * used for bvbox in tile lists */
+    rt_SIMD_SURFACE    *s_bvb;
+
 /*  methods */
 
     protected:
@@ -964,6 +999,61 @@ class rt_HyperParaboloid : public rt_Quadric
     rt_void update_fields();
 };
 
+/******************************************************************************/
+/**********************************   MESH   **********************************/
+/******************************************************************************/
+
+/*
+ * Mesh is a surface made of triangles with its own bvh,
+ * which is built once in local space and then mapped to backend's space
+ * of the surface (with trivial transform) whenever the object changes.
+ */
+class rt_Mesh : public rt_Surface
+{
+/*  fields */
+
+    private:
+
+    rt_MESH            *xms;
+
+    /* triangles in bvh order */
+    rt_si32            *tri_ord;
+
+    /* local space bvh nodes, 6 bounds,
+     * skip index and leaf's triangles range per node */
+    rt_real            *nod_box;
+    rt_si32            *nod_idx;
+    rt_si32             nod_num;
+
+    /* backend's bvh data */
+    rt_SIMD_MESHNODE   *s_nod;
+    rt_SIMD_MESHTRI    *s_tri;
+
+/*  methods */
+
+    private:
+
+    rt_void build_node(rt_si32 lo, rt_si32 hi);
+
+    protected:
+
+    virtual
+    rt_void adjust_minmax(rt_vec4 smin, rt_vec4 smax,  /* src */
+                          rt_vec4 bmin, rt_vec4 bmax,  /* bbox */
+                          rt_vec4 cmin, rt_vec4 cmax); /* cbox */
+
+    public:
+
+    rt_Mesh(rt_Registry *rg, rt_Object *parent, rt_OBJECT *obj,
+            rt_si32 ssize = 0);
+
+    virtual
+   ~rt_Mesh();
+
+    virtual
+    rt_void update_fields();
+};
+
 /******************************************************************************/
 /********************************   MATERIAL   ********************************/
 /******************************************************************************/
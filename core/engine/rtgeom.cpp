@@ -722,7 +722,8 @@ rt_si32 surf_conc(rt_SHAPE *srf)
     if (srf->tag == RT_TAG_CONE
     ||  srf->tag == RT_TAG_HYPERBOLOID
     ||  srf->tag == RT_TAG_HYPERCYLINDER
-    ||  srf->tag == RT_TAG_HYPERPARABOLOID)
+    ||  srf->tag == RT_TAG_HYPERPARABOLOID
+    ||  srf->tag == RT_TAG_MESH)
     {
         c = 1;
     }
@@ -756,7 +757,8 @@ rt_si32 clip_conc(rt_SHAPE *srf)
     {
         c = 1;
     }
-    if (srf->tag == RT_TAG_HYPERPARABOLOID)
+    if (srf->tag == RT_TAG_HYPERPARABOLOID
+    ||  srf->tag == RT_TAG_MESH)
     {
         c = 1;
     }
@@ -940,6 +942,14 @@ rt_si32 clip_side(rt_SHAPE *srf, rt_vec4 pos)
 {
     rt_si32 k, c = 0;
 
+    /* if "srf" is MESH,
+     * it has no analytic sides */
+    if (RT_IS_MESH(srf))
+    {
+        c = 3;
+        return c;
+    }
+
     c = surf_side(srf, pos);
 
     /* if "pos" is on the surface with margin,
@@ -994,47 +1004,26 @@ rt_si32 clip_side(rt_SHAPE *srf, rt_vec4 pos)
 }
 
 /*
- * Determine if "nd1's" bbox casts shadow on "nd2's" bbox
- * as seen from "obj's" bbox "mid" (light's "pos").
+ * Determine if bounding sphere with "mid" and "rad" casts shadow
+ * on "nd2's" bounding sphere as seen from "obj's" bbox "mid" (light's "pos").
  *
  * Return values:
  *   0 - no
  *   1 - yes
  */
-rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
+rt_si32 sphr_shad(rt_BOUND *obj, rt_real *mid, rt_real rad, rt_BOUND *nd2)
 {
-    /* check if nodes differ and have bounds */
-    if (nd1->rad == RT_INF || nd2->rad == RT_INF || nd1 == nd2)
+    /* check if nodes have bounds */
+    if (rad == RT_INF || nd2->rad == RT_INF)
     {
-        return 1; /* TODO: attempt to check shadow for boundless nodes */
+        return 1;
     }
 
     rt_real *pps = obj->mid;
-    rt_si32 i, j, k;
-
-    /* check if "nd1" and "nd2" is SURFACE
-     * and clip relations for shadow optimization is enabled in runtime */
-#if RT_OPTS_SHADOW_EXT2 != 0
-    if ((*obj->opts & RT_OPTS_SHADOW_EXT2) != 0
-    &&  RT_IS_SURFACE(nd1) && RT_IS_SURFACE(nd2))
-    {
-        rt_SHAPE *srf = (rt_SHAPE *)nd1;
-        rt_SHAPE *ref = (rt_SHAPE *)nd2;
-
-        /* check "srf's" and "ref's" clip relationship */
-        i = surf_clip(ref, srf);
-        j = surf_clip(srf, ref);
-
-        if (i != 0 || j != 0)
-        {
-            return 1;
-        }
-    }
-#endif /* RT_OPTS_SHADOW_EXT2 */
 
     /* check if cones from bounding spheres don't intersect */
     rt_vec4 nd1_vec;
-    RT_VEC3_SUB(nd1_vec, nd1->mid, pps);
+    RT_VEC3_SUB(nd1_vec, mid, pps);
     rt_real nd1_len = RT_VEC3_LEN(nd1_vec);
 
     rt_vec4 nd2_vec;
@@ -1044,8 +1033,8 @@ rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
     rt_real dff_ang = RT_VEC3_DOT(nd1_vec, nd2_vec);
 
     dff_ang = nd1_len <= RT_CULL_THRESHOLD ? 0.0f : dff_ang / nd1_len;
-    rt_real nd1_ang = nd1_len >= nd1->rad && nd1_len > RT_CULL_THRESHOLD ?
-                        RT_ASIN(nd1->rad / nd1_len) : (rt_real)RT_2_PI;
+    rt_real nd1_ang = nd1_len >= rad && nd1_len > RT_CULL_THRESHOLD ?
+                        RT_ASIN(rad / nd1_len) : (rt_real)RT_2_PI;
 
     dff_ang = nd2_len <= RT_CULL_THRESHOLD ? 0.0f : dff_ang / nd2_len;
     rt_real nd2_ang = nd2_len >= nd2->rad && nd2_len > RT_CULL_THRESHOLD ?
@@ -1060,16 +1049,64 @@ rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
 
     /* check if bounding spheres themselves don't intersect */
     rt_vec4 dff_vec;
-    RT_VEC3_SUB(dff_vec, nd1->mid, nd2->mid);
+    RT_VEC3_SUB(dff_vec, mid, nd2->mid);
     rt_real dff_len = RT_VEC3_LEN(dff_vec);
 
     /* check if shadow bounding sphere is fully behind */
-    if (nd1->rad + nd2->rad < dff_len
+    if (rad + nd2->rad < dff_len
     &&  nd1_len > nd2_len)
     {
         return 0;
     }
 
+    return 1;
+}
+
+/*
+ * Determine if "nd1's" bbox casts shadow on "nd2's" bbox
+ * as seen from "obj's" bbox "mid" (light's "pos").
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
+{
+    /* check if nodes differ and have bounds */
+    if (nd1->rad == RT_INF || nd2->rad == RT_INF || nd1 == nd2)
+    {
+        return 1; /* TODO: attempt to check shadow for boundless nodes */
+    }
+
+    rt_real *pps = obj->mid;
+    rt_si32 i, j, k;
+
+    /* check if "nd1" and "nd2" is SURFACE
+     * and clip relations for shadow optimization is enabled in runtime */
+#if RT_OPTS_SHADOW_EXT2 != 0
+    if ((*obj->opts & RT_OPTS_SHADOW_EXT2) != 0
+    &&  RT_IS_SURFACE(nd1) && RT_IS_SURFACE(nd2))
+    {
+        rt_SHAPE *srf = (rt_SHAPE *)nd1;
+        rt_SHAPE *ref = (rt_SHAPE *)nd2;
+
+        /* check "srf's" and "ref's" clip relationship */
+        i = surf_clip(ref, srf);
+        j = surf_clip(srf, ref);
+
+        if (i != 0 || j != 0)
+        {
+            return 1;
+        }
+    }
+#endif /* RT_OPTS_SHADOW_EXT2 */
+
+    /* check bounding spheres first */
+    if (sphr_shad(obj, nd1->mid, nd1->rad, nd2) == 0)
+    {
+        return 0;
+    }
+
     /* check if nodes don't have bounding boxes
      * or bbox relations for shadow optimization is disabled in runtime */
 #if RT_OPTS_SHADOW_EXT1 != 0
@@ -1151,6 +1188,60 @@ rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
     return 0;
 }
 
+/*
+ * Determine if "nd1's" bbox is within range "rng"
+ * from "obj's" bbox "mid" (light's "pos").
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 bbox_dist(rt_BOUND *obj, rt_real rng, rt_BOUND *nd1)
+{
+    /* check if range is limited and node has bounds */
+    if (rng == RT_INF || nd1->rad == RT_INF)
+    {
+        return 1;
+    }
+
+    rt_real *pps = obj->mid;
+    rt_real  len;
+    rt_si32  i;
+
+    /* check if bounding sphere is out of range */
+    rt_vec4 dff_vec;
+    RT_VEC3_SUB(dff_vec, nd1->mid, pps);
+    rt_real dff_len = RT_VEC3_LEN(dff_vec);
+
+    if (nd1->rad + rng < dff_len)
+    {
+        return 0;
+    }
+
+    /* check if node doesn't have bounding box
+     * or it is defined in trnode sub-world space,
+     * where distances might be scaled */
+    if (nd1->verts_num == 0 || nd1->trnode != RT_NULL)
+    {
+        return 1;
+    }
+
+    /* check if bounding box is out of range */
+    for (i = 0, len = 0.0f; i < 3; i++)
+    {
+        rt_real d = RT_MAX(nd1->bmin[i] - pps[i], pps[i] - nd1->bmax[i]);
+
+        len += d > 0.0f ? d * d : 0.0f;
+    }
+
+    if (rng * rng < len)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
 /*
  * Convert bbox flags from "flm" to "flf" format.
  *
@@ -1263,6 +1354,12 @@ rt_si32 bbox_sort(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2)
         rt_SHAPE *srf = (rt_SHAPE *)nd1;
         rt_SHAPE *ref = (rt_SHAPE *)nd2;
 
+        /* meshes have no analytic sides to sort by */
+        if (RT_IS_MESH(srf) || RT_IS_MESH(ref))
+        {
+            break;
+        }
+
         /* TODO: consider merging "p, q" into "m, n" as a third "planar" state
          * between "convex" and "concave", adjust code below to reflect that */
         p = RT_IS_PLANE(srf) ? 1 : 0;
@@ -1953,6 +2050,13 @@ rt_si32 bbox_fuse(rt_BOUND *nd1, rt_BOUND *nd2)
  */
 rt_si32 bbox_side(rt_BOUND *obj, rt_SHAPE *srf)
 {
+    /* check if "srf" is MESH,
+     * both sides can be seen from anywhere */
+    if (RT_IS_MESH(srf))
+    {
+        return 3;
+    }
+
     /* check if "obj" is LIGHT or CAMERA */
     if (RT_IS_LIGHT(obj) || RT_IS_CAMERA(obj))
     {
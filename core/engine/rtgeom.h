@@ -328,6 +328,27 @@ struct rt_SHAPE : public rt_BOUND
  */
 rt_si32 bbox_shad(rt_BOUND *obj, rt_BOUND *nd1, rt_BOUND *nd2);
 
+/*
+ * Determine if bounding sphere with "mid" and "rad" casts shadow
+ * on "nd2's" bounding sphere as seen from "obj's" bbox "mid" (light's "pos"),
+ * conservative part of "bbox_shad" for bounds kept from previous frames.
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 sphr_shad(rt_BOUND *obj, rt_real *mid, rt_real rad, rt_BOUND *nd2);
+
+/*
+ * Determine if "nd1's" bbox is within range "rng"
+ * from "obj's" bbox "mid" (light's "pos").
+ *
+ * Return values:
+ *   0 - no
+ *   1 - yes
+ */
+rt_si32 bbox_dist(rt_BOUND *obj, rt_real rng, rt_BOUND *nd1);
+
 /*
  * Convert bbox flags from "flm" to "flf" format.
  *
@@ -0,0 +1,812 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#if RT_EMBED_FILEIO == 0
+#include <stdio.h>
+#endif /* RT_EMBED_FILEIO */
+#include <stddef.h>
+#include <string.h>
+
+#include "rtscen.h"
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * rtscen.cpp: Implementation of the scene file utils library.
+ *
+ * Utility file for the engine responsible for scene saving and loading
+ * in binary format mirroring format.h structs, thus scenes can be changed
+ * without a rebuild and don't have to be compiled into the binary.
+ * Loading is a single file map with pointer fix-ups and no parsing,
+ * saving converts scenes defined as C static initializers (data/scenes).
+ *
+ * Files are specific to build's element and pointer sizes and endianness,
+ * offsets of the fix-ups are range-checked on load, as well as extents
+ * of all blocks (with their element counts) referenced from the scene,
+ * non-NULL pointer and animator fields must have been fixed up.
+ *
+ * Utility file names are usually in the form of rt****.cpp/h,
+ * while core engine parts are located in ******.cpp/h files.
+ */
+
+#if RT_EMBED_FILEIO == 0 && !(defined RT_WIN32) && !(defined RT_WIN64)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define RT_SCENE_MAP            1 /* map scene files */
+
+#else /* RT_EMBED_FILEIO, OS specific */
+
+#define RT_SCENE_MAP            0 /* read scene files to heap */
+
+#endif /* RT_EMBED_FILEIO, OS specific */
+
+#define RT_SCENE_DEPTH          256 /* max nesting of arrays checked on load */
+
+/******************************************************************************/
+/*********************************   SCENE   **********************************/
+/******************************************************************************/
+
+/*
+ * Return size of object's data by its "tag" (for non-array objects),
+ * 0 if the tag is unknown.
+ */
+static
+rt_word scene_size(rt_si32 tag)
+{
+    switch (tag)
+    {
+        case RT_TAG_CAMERA:
+        return sizeof(rt_CAMERA);
+
+        case RT_TAG_LIGHT:
+        return sizeof(rt_LIGHT);
+
+        case RT_TAG_PLANE:
+        return sizeof(rt_PLANE);
+
+        case RT_TAG_CYLINDER:
+        return sizeof(rt_CYLINDER);
+
+        case RT_TAG_SPHERE:
+        return sizeof(rt_SPHERE);
+
+        case RT_TAG_CONE:
+        return sizeof(rt_CONE);
+
+        case RT_TAG_PARABOLOID:
+        return sizeof(rt_PARABOLOID);
+
+        case RT_TAG_HYPERBOLOID:
+        return sizeof(rt_HYPERBOLOID);
+
+        case RT_TAG_PARACYLINDER:
+        return sizeof(rt_PARACYLINDER);
+
+        case RT_TAG_HYPERCYLINDER:
+        return sizeof(rt_HYPERCYLINDER);
+
+        case RT_TAG_HYPERPARABOLOID:
+        return sizeof(rt_HYPERPARABOLOID);
+
+        case RT_TAG_MESH:
+        return sizeof(rt_MESH);
+
+        default:
+        return 0;
+    }
+}
+
+/*
+ * Check if block of "num" elements of "size" bytes each at "ptr"
+ * lies within scene data from "lo" to "hi", NULL block must be empty.
+ */
+static
+rt_bool scene_span(rt_byte *lo, rt_byte *hi, rt_pntr ptr,
+                   rt_si32 num, rt_word size)
+{
+    rt_byte *p = (rt_byte *)ptr;
+
+    if (num < 0)
+    {
+        return RT_FALSE;
+    }
+
+    if (p == RT_NULL)
+    {
+        return num == 0;
+    }
+
+    return p >= lo && p <= hi && (rt_word)num <= (rt_word)(hi - p) / size;
+}
+
+/*
+ * Check if field "fld" within scene data from "lo" is NULL or has been
+ * fixed up by the entry of given "kind", as marked in "fxd" (RT_SCENE_FIX_*
+ * plus 1 per pointer-sized slot), file offsets are never left in place.
+ */
+static
+rt_bool scene_fixed(rt_byte *lo, rt_byte *fxd, rt_pntr fld, rt_word kind)
+{
+    return *(rt_pntr *)fld == RT_NULL
+        || fxd[((rt_byte *)fld - lo) / sizeof(rt_pntr)] == kind + 1;
+}
+
+/*
+ * Check extents of material referenced by field "pmat" and its texture data
+ * (file name or bound pixels) within scene data from "lo" to "hi".
+ */
+static
+rt_bool scene_chk_mat(rt_byte *lo, rt_byte *hi, rt_byte *fxd,
+                      rt_MATERIAL **pmat)
+{
+    rt_MATERIAL *mat = *pmat;
+
+    if (mat == RT_NULL)
+    {
+        return RT_TRUE;
+    }
+
+    if (!scene_fixed(lo, fxd, pmat, RT_SCENE_FIX_PTR)
+    ||  !scene_span(lo, hi, mat, 1, sizeof(rt_MATERIAL)))
+    {
+        return RT_FALSE;
+    }
+
+    rt_TEX *tx = &mat->tex;
+    rt_byte *p = (rt_byte *)tx->ptex;
+
+    if (!scene_fixed(lo, fxd, &tx->ptex, RT_SCENE_FIX_PTR)
+    ||  !scene_fixed(lo, fxd, &tx->prel, RT_SCENE_FIX_PTR))
+    {
+        return RT_FALSE;
+    }
+
+    if (p == RT_NULL)
+    {
+        return RT_TRUE;
+    }
+
+    if (tx->x_dim == 0 && tx->y_dim == 0)
+    {
+        return scene_span(lo, hi, p, 0, 1)
+            && memchr(p, 0, (rt_word)(hi - p)) != RT_NULL;
+    }
+
+    return tx->x_dim > 0 && tx->y_dim > 0
+        && scene_span(lo, hi, p, tx->x_dim, (rt_word)tx->y_dim * 4);
+}
+
+/*
+ * Check extents of all blocks referenced by object "obj" (with element
+ * counts) within scene data from "lo" to "hi", traverse sub-objects
+ * of arrays recursively up to RT_SCENE_DEPTH levels.
+ */
+static
+rt_bool scene_chk_obj(rt_byte *lo, rt_byte *hi, rt_byte *fxd,
+                      rt_OBJ *obj, rt_si32 depth)
+{
+    rt_si32 i;
+
+    if (depth > RT_SCENE_DEPTH
+    ||  !scene_chk_mat(lo, hi, fxd, &obj->pmat_outer)
+    ||  !scene_chk_mat(lo, hi, fxd, &obj->pmat_inner)
+    ||  !scene_fixed(lo, fxd, &obj->prel, RT_SCENE_FIX_PTR)
+    ||  !scene_span(lo, hi, obj->prel, obj->rel_num, sizeof(rt_RELATION))
+    ||  !scene_fixed(lo, fxd, &obj->pobj, RT_SCENE_FIX_PTR))
+    {
+        return RT_FALSE;
+    }
+
+    if (obj->pobj == RT_NULL)
+    {
+        return RT_TRUE;
+    }
+
+    if (RT_IS_ARRAY(obj))
+    {
+        rt_OBJECT *arr = (rt_OBJECT *)obj->pobj;
+
+        if (!scene_span(lo, hi, arr, obj->obj_num, sizeof(rt_OBJECT)))
+        {
+            return RT_FALSE;
+        }
+
+        for (i = 0; i < obj->obj_num; i++)
+        {
+            if (!scene_fixed(lo, fxd, &arr[i].f_anim, RT_SCENE_FIX_ANIM)
+            ||  !scene_chk_obj(lo, hi, fxd, &arr[i].obj, depth + 1))
+            {
+                return RT_FALSE;
+            }
+        }
+
+        return RT_TRUE;
+    }
+
+    rt_word size = scene_size(obj->tag);
+
+    if (size == 0 || !scene_span(lo, hi, obj->pobj, 1, size))
+    {
+        return RT_FALSE;
+    }
+
+    if (RT_IS_SURFACE(obj))
+    {
+        rt_SURFACE *srf = (rt_SURFACE *)obj->pobj;
+
+        if (!scene_chk_mat(lo, hi, fxd, &srf->side_outer.pmat)
+        ||  !scene_chk_mat(lo, hi, fxd, &srf->side_inner.pmat))
+        {
+            return RT_FALSE;
+        }
+    }
+
+    if (RT_IS_MESH(obj))
+    {
+        rt_MESH *msh = (rt_MESH *)obj->pobj;
+
+        if (!scene_fixed(lo, fxd, &msh->vrt, RT_SCENE_FIX_PTR)
+        ||  !scene_fixed(lo, fxd, &msh->idx, RT_SCENE_FIX_PTR)
+        ||  !scene_span(lo, hi, msh->vrt, msh->vrt_num, sizeof(rt_vec3))
+        ||  !scene_span(lo, hi, msh->idx, msh->tri_num, sizeof(rt_si32) * 3))
+        {
+            return RT_FALSE;
+        }
+    }
+
+    return RT_TRUE;
+}
+
+/*
+ * Load scene from binary file "name" (mapped if supported, otherwise read
+ * to heap "hp"), animators are bound by index from "f_anim" table.
+ */
+rt_SCENE* load_scene(rt_Heap *hp, rt_pstr name,
+                     rt_FUNC_ANIM3D *f_anim, rt_si32 anim_num)
+{
+#if RT_EMBED_FILEIO == 0
+    rt_byte *data = RT_NULL;
+    rt_word i, size = 0;
+
+#if RT_SCENE_MAP
+
+    struct stat st;
+    rt_si32 fd = open(name, O_RDONLY);
+
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= RT_SCENE_HEAD)
+    {
+        size = (rt_word)st.st_size;
+        /* private mapping as the engine writes to scene data at runtime */
+        data = (rt_byte *)mmap(RT_NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE, fd, 0);
+        data = data != (rt_byte *)MAP_FAILED ? data : RT_NULL;
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+#else /* RT_SCENE_MAP */
+
+    rt_SCENE_FILE head;
+    rt_File fl(name, "rb");
+    rt_File *f = &fl;
+
+    if (f->error() == 0 && f->load(&head, sizeof(rt_SCENE_FILE), 1) == 1
+    &&  head.size >= RT_SCENE_HEAD)
+    {
+        size = head.size;
+        data = (rt_byte *)hp->alloc(size, RT_QUAD_ALIGN);
+
+        if (f->seek(0, SEEK_SET) != 0 || f->load(data, size, 1) != 1)
+        {
+            /* release memory for scene data as loading failed,
+             * would also release all allocs made after data */
+            hp->release(data);
+            data = RT_NULL;
+        }
+    }
+
+#endif /* RT_SCENE_MAP */
+
+    if (data == RT_NULL)
+    {
+        throw rt_Exception("failed to load scene");
+    }
+
+    rt_SCENE_FILE *hdr = (rt_SCENE_FILE *)data;
+    rt_byte *fxd = RT_NULL;
+
+    /* all allocs made after this point
+     * are released when loading is done */
+    rt_pntr mark = hp->reserve(0, 0);
+
+    do /* use "do {break} while(0)" instead of "goto label" */
+    {
+        if (size < RT_SCENE_HEAD + sizeof(rt_SCENE)
+        ||  hdr->sig != RT_SCENE_SIG || hdr->ver != RT_SCENE_VER
+        ||  hdr->fmt != RT_SCENE_FMT || hdr->lay != RT_SCENE_LAY
+        ||  hdr->size != size || hdr->fix % sizeof(rt_word) != 0
+        ||  hdr->fix < RT_SCENE_HEAD + sizeof(rt_SCENE) || hdr->fix > size
+        ||  hdr->fix_num > (size - hdr->fix) / sizeof(rt_word))
+        {
+            break;
+        }
+
+        if (hdr->anim > 0 && (f_anim == RT_NULL
+        ||  hdr->anim > (rt_word)anim_num))
+        {
+            break;
+        }
+
+        rt_word *fix = (rt_word *)(data + hdr->fix);
+
+        /* kind of fix-up (plus 1) per pointer-sized slot of scene data,
+         * 0 for slots not fixed up, each slot is fixed up only once */
+        fxd = (rt_byte *)hp->alloc((hdr->fix - RT_SCENE_HEAD)
+                                 / sizeof(rt_pntr) + 1, RT_ALIGN);
+        memset(fxd, 0, (hdr->fix - RT_SCENE_HEAD) / sizeof(rt_pntr) + 1);
+
+        /* turn stored offsets and indices into pointers */
+        for (i = 0; i < hdr->fix_num; i++)
+        {
+            rt_word at = fix[i] & ~(rt_word)1;
+
+            if (at < RT_SCENE_HEAD || at > hdr->fix - sizeof(rt_pntr)
+            ||  at % sizeof(rt_pntr) != 0
+            ||  fxd[(at - RT_SCENE_HEAD) / sizeof(rt_pntr)] != 0)
+            {
+                break;
+            }
+
+            fxd[(at - RT_SCENE_HEAD) / sizeof(rt_pntr)] = (fix[i] & 1) + 1;
+
+            rt_word *val = (rt_word *)(data + at);
+
+            if (*val == 0)
+            {
+                continue;
+            }
+
+            if ((fix[i] & 1) == RT_SCENE_FIX_PTR)
+            {
+                if (*val < RT_SCENE_HEAD || *val >= hdr->fix)
+                {
+                    break;
+                }
+               *(rt_pntr *)val = data + *val;
+            }
+            else
+            {
+                if (*val > hdr->anim)
+                {
+                    break;
+                }
+               *(rt_FUNC_ANIM3D *)val = f_anim[*val - 1];
+            }
+        }
+
+        if (i < hdr->fix_num)
+        {
+            break;
+        }
+
+        rt_SCENE *scn = (rt_SCENE *)(data + RT_SCENE_HEAD);
+
+        /* check counted blocks against their extents
+         * and pointer fields against their fix-ups */
+        if (!scene_chk_obj(data + RT_SCENE_HEAD, data + hdr->fix, fxd,
+                           &scn->root, 0))
+        {
+            break;
+        }
+
+        hp->release(mark);
+
+        hdr->map = RT_SCENE_MAP;
+        scn->lock = RT_NULL;
+
+        return scn;
+    }
+    while (0);
+
+    hp->release(mark);
+
+#if RT_SCENE_MAP
+    munmap(data, size);
+#else /* RT_SCENE_MAP */
+    hp->release(data);
+#endif /* RT_SCENE_MAP */
+
+    throw rt_Exception("invalid scene file");
+#else /* RT_EMBED_FILEIO */
+    throw rt_Exception("failed to load scene");
+#endif /* RT_EMBED_FILEIO */
+}
+
+/*
+ * Free scene loaded from binary file (unmap if mapped),
+ * scene instances using it must be deleted before.
+ */
+rt_void free_scene(rt_SCENE *scn)
+{
+#if RT_SCENE_MAP
+    rt_SCENE_FILE *hdr = (rt_SCENE_FILE *)((rt_byte *)scn - RT_SCENE_HEAD);
+
+    if (hdr->map != 0)
+    {
+        munmap(hdr, hdr->size);
+    }
+#endif /* RT_SCENE_MAP */
+}
+
+/* context of scene saving, blocks of scene data are placed in the file
+ * and fix-ups counted on the first pass ("data" is NULL), second pass
+ * fills the same offsets as the traversal order is the same */
+struct rt_SCENE_CTX
+{
+    rt_Heap            *hp;
+
+    rt_byte            *data;
+    rt_word             size;
+    rt_word            *fix;
+    rt_word             fix_num;
+
+    /* hashmap from source addresses to file offsets,
+     * shared data (like materials) is saved only once */
+    rt_pntr            *key;
+    rt_word            *val;
+    rt_word             map_max;
+    rt_word             map_num;
+
+    rt_FUNC_ANIM3D     *f_anim;
+    rt_si32             anim_num;
+    rt_word             anim;
+};
+
+/*
+ * Double the capacity of the hashmap in saving context "ctx",
+ * previous hashmap arrays are released with the rest of the context.
+ */
+static
+rt_void scene_grow(rt_SCENE_CTX *ctx)
+{
+    rt_pntr *key = ctx->key;
+    rt_word *val = ctx->val;
+    rt_word i, j, n = ctx->map_max;
+
+    ctx->map_max = n == 0 ? 1024 : n * 2;
+    ctx->key = (rt_pntr *)ctx->hp->alloc(sizeof(rt_pntr) * ctx->map_max,
+                                          RT_ALIGN);
+    ctx->val = (rt_word *)ctx->hp->alloc(sizeof(rt_word) * ctx->map_max,
+                                          RT_ALIGN);
+    memset(ctx->key, 0, sizeof(rt_pntr) * ctx->map_max);
+
+    for (i = 0; i < n; i++)
+    {
+        if (key[i] == RT_NULL)
+        {
+            continue;
+        }
+
+        j = ((rt_word)key[i] >> 4) * 2654435761U & (ctx->map_max - 1);
+
+        while (ctx->key[j] != RT_NULL)
+        {
+            j = (j + 1) & (ctx->map_max - 1);
+        }
+
+        ctx->key[j] = key[i];
+        ctx->val[j] = val[i];
+    }
+}
+
+/*
+ * Place block of "size" bytes from "src" in the file (once per address),
+ * return its offset, "fresh" is set if the block has just been placed.
+ */
+static
+rt_word scene_block(rt_SCENE_CTX *ctx, rt_pntr src, rt_word size,
+                    rt_word align, rt_bool *fresh)
+{
+    rt_word j;
+
+    if (ctx->map_num * 2 >= ctx->map_max)
+    {
+        scene_grow(ctx);
+    }
+
+    j = ((rt_word)src >> 4) * 2654435761U & (ctx->map_max - 1);
+
+    while (ctx->key[j] != RT_NULL)
+    {
+        if (ctx->key[j] == src)
+        {
+           *fresh = RT_FALSE;
+            return ctx->val[j];
+        }
+
+        j = (j + 1) & (ctx->map_max - 1);
+    }
+
+    rt_word off = (ctx->size + align - 1) & ~(align - 1);
+
+    ctx->key[j] = src;
+    ctx->val[j] = off;
+    ctx->map_num++;
+
+    ctx->size = off + size;
+
+    if (ctx->data != RT_NULL)
+    {
+        memcpy(ctx->data + off, src, size);
+    }
+
+   *fresh = RT_TRUE;
+    return off;
+}
+
+/*
+ * Store "val" to pointer field at offset "at" in the file,
+ * add fix-up entry of given "kind" for it.
+ */
+static
+rt_void scene_fix(rt_SCENE_CTX *ctx, rt_word at, rt_word val, rt_word kind)
+{
+    if (ctx->data != RT_NULL)
+    {
+       *(rt_word *)(ctx->data + at) = val;
+        ctx->fix[ctx->fix_num] = at | kind;
+    }
+
+    ctx->fix_num++;
+}
+
+/*
+ * Place material "mat" referenced by pointer field at offset "at"
+ * along with its texture data (file name or bound pixels).
+ */
+static
+rt_void scene_mat(rt_SCENE_CTX *ctx, rt_word at, rt_MATERIAL *mat)
+{
+    rt_bool fresh;
+
+    if (mat == RT_NULL)
+    {
+        return;
+    }
+
+    rt_word off = scene_block(ctx, mat, sizeof(rt_MATERIAL),
+                              RT_QUAD_ALIGN, &fresh);
+    scene_fix(ctx, at, off, RT_SCENE_FIX_PTR);
+
+    rt_TEX *tx = &mat->tex;
+
+    if (tx->prel != RT_NULL)
+    {
+        throw rt_Exception("texture relations are not supported in save_scene");
+    }
+
+    if (!fresh || tx->ptex == RT_NULL)
+    {
+        return;
+    }
+
+    if (tx->tag == RT_TAG_ARRAY)
+    {
+        throw rt_Exception("texture arrays are not supported in save_scene");
+    }
+
+    /* texture load is requested by file name,
+     * otherwise texture data is bound from local array */
+    rt_word size = tx->x_dim == 0 && tx->y_dim == 0 ?
+                   strlen((rt_pstr)tx->ptex) + 1 : tx->x_dim * tx->y_dim * 4;
+
+    rt_word ptex = scene_block(ctx, tx->ptex, size, RT_QUAD_ALIGN, &fresh);
+    scene_fix(ctx, off + offsetof(rt_MATERIAL, tex) + offsetof(rt_TEX, ptex),
+              ptex, RT_SCENE_FIX_PTR);
+}
+
+/*
+ * Place data referenced by object "obj" at offset "at" in the file,
+ * traverse sub-objects of arrays recursively.
+ */
+static
+rt_void scene_obj(rt_SCENE_CTX *ctx, rt_word at, rt_OBJ *obj)
+{
+    rt_word off, size = 0;
+    rt_bool fresh;
+    rt_si32 i, k;
+
+    scene_mat(ctx, at + offsetof(rt_OBJ, pmat_outer), obj->pmat_outer);
+    scene_mat(ctx, at + offsetof(rt_OBJ, pmat_inner), obj->pmat_inner);
+
+    if (obj->prel != RT_NULL)
+    {
+        off = scene_block(ctx, obj->prel, sizeof(rt_RELATION) * obj->rel_num,
+                          RT_ALIGN, &fresh);
+        scene_fix(ctx, at + offsetof(rt_OBJ, prel), off, RT_SCENE_FIX_PTR);
+    }
+
+    if (obj->pobj == RT_NULL)
+    {
+        return;
+    }
+
+    if (RT_IS_ARRAY(obj))
+    {
+        rt_OBJECT *arr = (rt_OBJECT *)obj->pobj;
+
+        off = scene_block(ctx, arr, sizeof(rt_OBJECT) * obj->obj_num,
+                          RT_QUAD_ALIGN, &fresh);
+        scene_fix(ctx, at + offsetof(rt_OBJ, pobj), off, RT_SCENE_FIX_PTR);
+
+        for (i = 0; fresh && i < obj->obj_num; i++)
+        {
+            rt_word elm = off + sizeof(rt_OBJECT) * i;
+
+            scene_obj(ctx, elm + offsetof(rt_OBJECT, obj), &arr[i].obj);
+
+            if (arr[i].f_anim == RT_NULL)
+            {
+                continue;
+            }
+
+            for (k = 0; k < ctx->anim_num; k++)
+            {
+                if (ctx->f_anim[k] == arr[i].f_anim)
+                {
+                    break;
+                }
+            }
+
+            if (k == ctx->anim_num)
+            {
+                throw rt_Exception("animator not in table in save_scene");
+            }
+
+            ctx->anim = RT_MAX(ctx->anim, (rt_word)k + 1);
+            scene_fix(ctx, elm + offsetof(rt_OBJECT, f_anim),
+                      (rt_word)k + 1, RT_SCENE_FIX_ANIM);
+        }
+
+        return;
+    }
+
+    size = scene_size(obj->tag);
+
+    if (size == 0)
+    {
+        throw rt_Exception("unknown object tag in save_scene");
+    }
+
+    off = scene_block(ctx, obj->pobj, size, RT_QUAD_ALIGN, &fresh);
+    scene_fix(ctx, at + offsetof(rt_OBJ, pobj), off, RT_SCENE_FIX_PTR);
+
+    if (fresh && RT_IS_SURFACE(obj))
+    {
+        rt_SURFACE *srf = (rt_SURFACE *)obj->pobj;
+
+        scene_mat(ctx, off + offsetof(rt_SURFACE, side_outer)
+                           + offsetof(rt_SIDE, pmat), srf->side_outer.pmat);
+        scene_mat(ctx, off + offsetof(rt_SURFACE, side_inner)
+                           + offsetof(rt_SIDE, pmat), srf->side_inner.pmat);
+    }
+
+    if (fresh && RT_IS_MESH(obj))
+    {
+        rt_MESH *msh = (rt_MESH *)obj->pobj;
+        rt_word blk;
+
+        blk = scene_block(ctx, msh->vrt, sizeof(rt_vec3) * msh->vrt_num,
+                          RT_ALIGN, &fresh);
+        scene_fix(ctx, off + offsetof(rt_MESH, vrt), blk, RT_SCENE_FIX_PTR);
+
+        blk = scene_block(ctx, msh->idx, sizeof(rt_si32) * msh->tri_num * 3,
+                          RT_ALIGN, &fresh);
+        scene_fix(ctx, off + offsetof(rt_MESH, idx), blk, RT_SCENE_FIX_PTR);
+    }
+}
+
+/*
+ * Save scene "scn" (for instance, from C static initializers) to binary file
+ * "name", animators are stored as indices in "f_anim" table.
+ */
+rt_void save_scene(rt_Heap *hp, rt_pstr name, rt_SCENE *scn,
+                   rt_FUNC_ANIM3D *f_anim, rt_si32 anim_num)
+{
+#if RT_EMBED_FILEIO == 0
+    /* scene instances resolve textures in place */
+    if (scn->lock != RT_NULL)
+    {
+        throw rt_Exception("scene data is locked by another instance");
+    }
+
+    rt_SCENE_CTX cx, *ctx = &cx;
+    memset(ctx, 0, sizeof(rt_SCENE_CTX));
+
+    ctx->hp = hp;
+    ctx->f_anim = f_anim;
+    ctx->anim_num = f_anim != RT_NULL ? anim_num : 0;
+
+    /* all allocs made after this point
+     * are released when saving is done */
+    rt_pntr mark = hp->reserve(0, 0);
+    rt_word off, fix = 0, size = 0;
+    rt_bool fresh;
+    rt_si32 k;
+
+    try
+    {
+        for (k = 0; k < 2; k++)
+        {
+            ctx->size = RT_SCENE_HEAD;
+            ctx->fix_num = 0;
+            ctx->map_num = 0;
+            ctx->anim = 0;
+
+            if (ctx->key != RT_NULL)
+            {
+                memset(ctx->key, 0, sizeof(rt_pntr) * ctx->map_max);
+            }
+
+            off = scene_block(ctx, scn, sizeof(rt_SCENE),
+                              RT_QUAD_ALIGN, &fresh);
+            scene_obj(ctx, off + offsetof(rt_SCENE, root), &scn->root);
+
+            if (k == 0)
+            {
+                fix  = (ctx->size + sizeof(rt_word) - 1)
+                                  & ~(sizeof(rt_word) - 1);
+                size = fix + sizeof(rt_word) * ctx->fix_num;
+
+                ctx->data = (rt_byte *)hp->alloc(size, RT_QUAD_ALIGN);
+                memset(ctx->data, 0, size);
+                ctx->fix = (rt_word *)(ctx->data + fix);
+            }
+        }
+
+        rt_SCENE_FILE *hdr = (rt_SCENE_FILE *)ctx->data;
+
+        hdr->sig = RT_SCENE_SIG;
+        hdr->ver = RT_SCENE_VER;
+        hdr->fmt = RT_SCENE_FMT;
+        hdr->lay = RT_SCENE_LAY;
+
+        hdr->size = size;
+        hdr->fix = fix;
+        hdr->fix_num = ctx->fix_num;
+        hdr->anim = ctx->anim;
+        hdr->map = 0;
+
+        rt_File fl(name, "wb");
+        rt_File *f = &fl;
+
+        if (f->error() != 0 || f->save(ctx->data, size, 1) != 1)
+        {
+            throw rt_Exception("failed to save scene");
+        }
+    }
+    catch (rt_Exception e)
+    {
+        hp->release(mark);
+        throw;
+    }
+
+    hp->release(mark);
+#endif /* RT_EMBED_FILEIO */
+}
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
@@ -0,0 +1,95 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#ifndef RT_RTSCEN_H
+#define RT_RTSCEN_H
+
+#include "rtbase.h"
+#include "format.h"
+#include "system.h"
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * rtscen.h: Interface for the scene file utils library.
+ *
+ * More detailed description of this subsystem is given in rtscen.cpp.
+ * Recommended naming scheme for C++ types and definitions is given in rtbase.h.
+ */
+
+/******************************************************************************/
+/*******************************   DEFINITIONS   ******************************/
+/******************************************************************************/
+
+#define RT_SCENE_SIG            0x43535251 /* "QRSC" in little-endian */
+#define RT_SCENE_VER            1
+
+/* layout of format.h structs the file was written with,
+ * files can only be loaded by builds with the same layout */
+#define RT_SCENE_FMT            (RT_ELEMENT | RT_POINTER << 8 |             \
+                                 RT_ENDIAN << 16)
+
+#define RT_SCENE_LAY            (sizeof(rt_OBJECT) | sizeof(rt_MATERIAL) << 16)
+
+/* scene (rt_SCENE) starts at this offset in the file */
+#define RT_SCENE_HEAD           64
+
+/* fix-up table entry's kind (lowest bit) */
+#define RT_SCENE_FIX_PTR        0 /* pointer field, offset (0 - NULL) */
+#define RT_SCENE_FIX_ANIM       1 /* animator field, index + 1 (0 - none) */
+
+/*
+ * Binary scene file header, followed by format.h structs (rt_SCENE first)
+ * with pointer fields stored as offsets from the file's start and then by
+ * the table of fix-up entries (rt_word each), which hold file offsets of
+ * all pointer fields, thus loading is a single map plus pointer fix-ups.
+ */
+struct rt_SCENE_FILE
+{
+    rt_ui32             sig;    /* RT_SCENE_SIG */
+    rt_ui32             ver;    /* RT_SCENE_VER */
+    rt_ui32             fmt;    /* RT_SCENE_FMT */
+    rt_ui32             lay;    /* RT_SCENE_LAY */
+
+    rt_word             size;   /* file size in bytes */
+    rt_word             fix;    /* offset of fix-up table */
+    rt_word             fix_num;
+    rt_word             anim;   /* number of animators referenced */
+
+    rt_word             map;    /* 1 - mapped, 0 - read to heap (runtime) */
+};
+
+/******************************************************************************/
+/*********************************   SCENE   **********************************/
+/******************************************************************************/
+
+/*
+ * Load scene from binary file "name" (mapped if supported, otherwise read
+ * to heap "hp"), animators are bound by index from "f_anim" table.
+ */
+rt_SCENE* load_scene(rt_Heap *hp, rt_pstr name,
+                     rt_FUNC_ANIM3D *f_anim, rt_si32 anim_num);
+
+/*
+ * Free scene loaded from binary file (unmap if mapped),
+ * scene instances using it must be deleted before.
+ */
+rt_void free_scene(rt_SCENE *scn);
+
+/*
+ * Save scene "scn" (for instance, from C static initializers) to binary file
+ * "name", animators are stored as indices in "f_anim" table.
+ */
+rt_void save_scene(rt_Heap *hp, rt_pstr name, rt_SCENE *scn,
+                   rt_FUNC_ANIM3D *f_anim, rt_si32 anim_num);
+
+#endif /* RT_RTSCEN_H */
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
@@ -0,0 +1,983 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "posix.h"
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * posix.cpp: Implementation of the POSIX platform layer.
+ *
+ * Platform layer for Linux and macOS responsible for system time,
+ * system heap allocations and the pool of worker threads running
+ * scene's update and render slices, used by RooT's Linux front-end
+ * as well as the headless render farm (farm.h) in applications.
+ */
+
+#include <sys/time.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#ifndef RT_FUTEX
+#define RT_FUTEX 1
+#endif /* RT_FUTEX */
+
+#ifndef RT_SPINS
+#define RT_SPINS 256 /* wait-word's busy-wait spins before sleeping */
+#endif /* RT_SPINS */
+
+/* CPU relax hint for busy-wait loops */
+#if   (defined RT_X86) || (defined RT_X32) || (defined RT_X64)
+#define RT_RELAX()  asm volatile ("pause" ::: "memory")
+#elif (defined RT_ARM) || (defined RT_A32) || (defined RT_A64)
+#define RT_RELAX()  asm volatile ("yield" ::: "memory")
+#else /* other targets only prevent compiler from caching the loads */
+#define RT_RELAX()  asm volatile ("" ::: "memory")
+#endif /* RT_X86, RT_X32/X64, RT_ARM, RT_A32/A64 */
+
+#ifdef __APPLE__
+
+#undef  RT_SETAFFINITY /* setting thread affinity is not present on macOS */
+#define RT_SETAFFINITY 0
+
+#undef  RT_FUTEX /* futex is not present on macOS, sleep on condition */
+#define RT_FUTEX 0
+
+#endif /* __APPLE__ */
+
+#if RT_FUTEX
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif /* RT_FUTEX */
+
+/******************************************************************************/
+/**********************************   TIME   **********************************/
+/******************************************************************************/
+
+/*
+ * Get system time in milliseconds.
+ */
+rt_time get_time()
+{
+    timeval tm;
+    gettimeofday(&tm, NULL);
+    return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
+}
+
+/*
+ * Get monotonic time in microseconds.
+ */
+rt_time get_usec()
+{
+#ifdef __APPLE__
+    timeval tm;
+    gettimeofday(&tm, NULL);
+    return (rt_time)tm.tv_sec * 1000000 + tm.tv_usec;
+#else /* Linux */
+    timespec tm;
+    clock_gettime(CLOCK_MONOTONIC, &tm);
+    return (rt_time)tm.tv_sec * 1000000 + tm.tv_nsec / 1000;
+#endif /* __APPLE__ */
+}
+
+/******************************************************************************/
+/**********************************   HEAP   **********************************/
+/******************************************************************************/
+
+
+static
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#if RT_POINTER == 64
+#if RT_ADDRESS == 32
+
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000010000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)RT_ADDRESS_TOP)
+
+/* hint step past foreign mappings */
+#define RT_ADDRESS_STEP     0x0000000001000000
+
+#else /* RT_ADDRESS == 64 */
+
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000140000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)0x0000080000000000)
+
+#endif /* RT_ADDRESS */
+
+static
+rt_byte *s_ptr = RT_ADDRESS_MIN;
+
+#endif /* RT_POINTER */
+
+
+#include <sys/mman.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON  /* workaround for macOS compilation */
+#endif /* macOS still cannot allocate with mmap within 32-bit range */
+
+/* allocations of whole huge pages
+ * (heap's huge chunk classes) */
+#define RT_IS_HUGE(size)                                                    \
+        ((size) >= RT_CHUNK_HUGE && (size) % RT_CHUNK_HUGE == 0)
+
+/* huge-page mode of
+ * system heap allocations */
+static
+rt_si32 s_huge = 0;
+
+/*
+ * Set huge-page mode for allocations of whole huge pages: 0 - off,
+ * 1 - transparent, 2 - explicit (falls back to transparent if not reserved),
+ * return the mode applied (0 if not supported).
+ */
+rt_si32 sys_huge(rt_si32 mode)
+{
+    pthread_mutex_lock(&mutex);
+
+#if (defined MADV_HUGEPAGE) || (defined MAP_HUGETLB)
+    s_huge = RT_MAX(0, RT_MIN(mode, 2));
+#endif /* MADV_HUGEPAGE, MAP_HUGETLB */
+
+    pthread_mutex_unlock(&mutex);
+
+    return s_huge;
+}
+
+/*
+ * Map "size" bytes at "hint" (anywhere if NULL), align allocations of whole
+ * huge pages to huge page boundary and back them with huge pages if enabled,
+ * return MAP_FAILED if failed.
+ */
+static
+rt_pntr sys_map(rt_byte *hint, rt_size size)
+{
+    rt_byte *ptr = (rt_byte *)MAP_FAILED;
+
+    if (s_huge == 0 || !RT_IS_HUGE(size))
+    {
+        return mmap(hint, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+
+    hint = (rt_byte *)(((rt_word)hint + RT_CHUNK_HUGE - 1) &
+                                     ~(rt_word)(RT_CHUNK_HUGE - 1));
+
+#if (defined MAP_HUGETLB)
+
+    if (s_huge == 2)
+    {
+        ptr = (rt_byte *)mmap(hint, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+
+#endif /* MAP_HUGETLB */
+
+    if (ptr != (rt_byte *)MAP_FAILED)
+    {
+        return ptr;
+    }
+
+    /* over-allocate by one huge page to align the result,
+     * then trim unaligned head and tail */
+    rt_byte *raw = (rt_byte *)mmap(hint, size + RT_CHUNK_HUGE,
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (raw == (rt_byte *)MAP_FAILED)
+    {
+        return MAP_FAILED;
+    }
+
+    ptr = (rt_byte *)(((rt_word)raw + RT_CHUNK_HUGE - 1) &
+                                    ~(rt_word)(RT_CHUNK_HUGE - 1));
+
+    if (ptr > raw)
+    {
+        munmap(raw, ptr - raw);
+    }
+    if (ptr < raw + RT_CHUNK_HUGE)
+    {
+        munmap(ptr + size, raw + RT_CHUNK_HUGE - ptr);
+    }
+
+#if (defined MADV_HUGEPAGE)
+
+    madvise(ptr, size, MADV_HUGEPAGE);
+
+#endif /* MADV_HUGEPAGE */
+
+    return ptr;
+}
+
+/*
+ * Allocate memory from system heap.
+ */
+rt_pntr sys_alloc(rt_size size)
+{
+    pthread_mutex_lock(&mutex);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    rt_pntr ptr = RT_NULL;
+    rt_si32 wrap = 0;
+
+    /* in 64/32-bit hybrid mode addresses can't exceed RT_ADDRESS_TOP
+     * (rtbase.h), mmap hint skips past mappings already in the range
+     * and loops around RT_ADDRESS_MAX boundary at most once */
+    while (wrap < 2 && size < RT_ADDRESS_MAX - RT_ADDRESS_MIN)
+    {
+        if (s_ptr >= RT_ADDRESS_MAX - size)
+        {
+            s_ptr  = RT_ADDRESS_MIN;
+            wrap++;
+            continue;
+        }
+
+        ptr = sys_map(s_ptr, size);
+
+        if (ptr != MAP_FAILED && (rt_byte *)ptr >= RT_ADDRESS_MIN
+        &&  (rt_byte *)ptr < RT_ADDRESS_MAX - size)
+        {
+            break;
+        }
+
+        if (ptr != MAP_FAILED)
+        {
+            munmap(ptr, size);
+        }
+
+        ptr = RT_NULL;
+        s_ptr += RT_ADDRESS_STEP;
+    }
+
+    /* advance with allocation granularity */
+    /* in case when page-size differs from default 4096 bytes
+     * mmap should round toward closest correct page boundary */
+    if (ptr != RT_NULL)
+    {
+        s_ptr = (rt_byte *)ptr + ((size + 4095) / 4096) * 4096;
+    }
+
+#else /* (RT_POINTER - RT_ADDRESS) */
+
+    /* whole huge pages are always mapped,
+     * thus sys_free can tell them by size */
+    rt_pntr ptr = RT_IS_HUGE(size) ? sys_map(RT_NULL, size) : malloc(size);
+
+    if (ptr == MAP_FAILED)
+    {
+        ptr = RT_NULL;
+    }
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+#if RT_DEBUG >= 2
+
+    RT_LOGI("ALLOC PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
+
+#endif /* RT_DEBUG */
+
+    pthread_mutex_unlock(&mutex);
+
+    if (ptr == RT_NULL)
+    {
+        throw rt_Exception("alloc failed with NULL address in sys_alloc");
+    }
+
+    return ptr;
+}
+
+/*
+ * Free memory from system heap.
+ */
+rt_void sys_free(rt_pntr ptr, rt_size size)
+{
+    pthread_mutex_lock(&mutex);
+
+#if (RT_POINTER - RT_ADDRESS) != 0
+
+    munmap(ptr, size);
+
+#else /* (RT_POINTER - RT_ADDRESS) */
+
+    if (RT_IS_HUGE(size))
+    {
+        munmap(ptr, size);
+    }
+    else
+    {
+        free(ptr);
+    }
+
+#endif /* (RT_POINTER - RT_ADDRESS) */
+
+#if RT_DEBUG >= 2
+
+    RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
+
+#endif /* RT_DEBUG */
+
+    pthread_mutex_unlock(&mutex);
+}
+
+/******************************************************************************/
+/*****************************   MULTI-THREADING   ****************************/
+/******************************************************************************/
+
+/*
+ * Initialize wait-word "wait" with value "word".
+ */
+rt_void wait_init(rt_WAIT *wait, rt_si32 word)
+{
+    wait->word = word;
+    wait->sleep = 0;
+
+#if RT_FUTEX == 0
+    pthread_mutex_init(&wait->mutex, NULL);
+    pthread_cond_init(&wait->cond, NULL);
+#endif /* RT_FUTEX */
+}
+
+/*
+ * Terminate wait-word "wait".
+ */
+rt_void wait_term(rt_WAIT *wait)
+{
+#if RT_FUTEX == 0
+    pthread_cond_destroy(&wait->cond);
+    pthread_mutex_destroy(&wait->mutex);
+#endif /* RT_FUTEX */
+}
+
+/*
+ * Wait until wait-word differs from "word", spinning with CPU relax hint
+ * for a bounded number of iterations before sleeping on futex
+ * (or on condition variable if futex is not present).
+ * Sleepers are counted before the word is checked again,
+ * thus a change made before it is read by wait_wake is never missed.
+ */
+rt_void wait_word(rt_WAIT *wait, rt_si32 word)
+{
+    rt_si32 i;
+
+    for (i = 0; wait->word == word; i++)
+    {
+        if (i < RT_SPINS)
+        {
+            RT_RELAX();
+            continue;
+        }
+
+#if RT_FUTEX
+        RT_ATOMIC_ADD(&wait->sleep, +1);
+        syscall(SYS_futex, &wait->word, FUTEX_WAIT_PRIVATE,
+                word, NULL, NULL, 0);
+        RT_ATOMIC_ADD(&wait->sleep, -1);
+#else /* RT_FUTEX */
+        pthread_mutex_lock(&wait->mutex);
+        RT_ATOMIC_ADD(&wait->sleep, +1);
+        while (wait->word == word)
+        {
+            pthread_cond_wait(&wait->cond, &wait->mutex);
+        }
+        RT_ATOMIC_ADD(&wait->sleep, -1);
+        pthread_mutex_unlock(&wait->mutex);
+#endif /* RT_FUTEX */
+    }
+
+    __sync_synchronize();
+}
+
+/*
+ * Wake threads sleeping on wait-word after it has been changed,
+ * nothing is done if none of them is asleep.
+ */
+rt_void wait_wake(rt_WAIT *wait)
+{
+    __sync_synchronize();
+
+    if (wait->sleep == 0)
+    {
+        return;
+    }
+
+#if RT_FUTEX
+    syscall(SYS_futex, &wait->word, FUTEX_WAKE_PRIVATE,
+            0x7FFFFFFF, NULL, NULL, 0);
+#else /* RT_FUTEX */
+    pthread_mutex_lock(&wait->mutex);
+    pthread_cond_broadcast(&wait->cond);
+    pthread_mutex_unlock(&wait->mutex);
+#endif /* RT_FUTEX */
+}
+
+/* sense-reversing barrier
+ * for "total" threads */
+struct rt_BARRIER
+{
+    volatile rt_si32    count;
+    rt_WAIT             sense;
+    rt_si32             total;
+};
+
+/*
+ * Initialize barrier for "total" threads.
+ */
+static
+rt_void barrier_init(rt_BARRIER *barr, rt_si32 total)
+{
+    barr->count = 0;
+    barr->total = total;
+    wait_init(&barr->sense, 0);
+}
+
+/*
+ * Terminate barrier.
+ */
+static
+rt_void barrier_term(rt_BARRIER *barr)
+{
+    wait_term(&barr->sense);
+}
+
+/*
+ * Wait on barrier until all threads arrive, "sense" is thread's local sense.
+ * Waiting threads wait on barrier's sense-word to flip (spinning first),
+ * the last thread to arrive releases others and only wakes them if asleep.
+ */
+static
+rt_void barrier_wait(rt_BARRIER *barr, rt_si32 *sense)
+{
+    rt_si32 s = 1 - *sense;
+   *sense = s;
+
+    if (RT_ATOMIC_ADD(&barr->count, 1) == barr->total - 1)
+    {
+        barr->count = 0;
+        __sync_synchronize();
+        barr->sense.word = s;
+        wait_wake(&barr->sense);
+
+        return;
+    }
+
+    wait_word(&barr->sense, 1 - s);
+}
+
+struct rt_THREAD;
+
+/* pool of "thnum" threads,
+ * "estr" holds exceptions
+ * from worker-threads */
+struct rt_THREAD_POOL
+{
+    rt_Platform        *pfm;
+    rt_si32             cmd;
+    rt_si32             thnum;
+    rt_THREAD          *thread;
+    rt_BARRIER          barr[2];
+    rt_si32             sense[2];
+    volatile rt_si32    eout;
+    rt_pstr            *estr;
+};
+
+/* pool's thread */
+struct rt_THREAD
+{
+    rt_THREAD_POOL     *tpool;
+    rt_si32             index;
+    rt_si32             sense[2];
+    pthread_t           pthr;
+};
+
+/*
+ * Worker thread's entry point.
+ */
+static
+rt_pntr worker_thread(rt_pntr p)
+{
+    rt_THREAD *thread = (rt_THREAD *)p;
+    rt_si32 ti = thread->index;
+
+    while (thread->tpool->cmd < 0) /* <- wait for barriers */
+    {
+        sched_yield();
+    }
+
+    while (1)
+    {
+        /* every worker-thread waits signal from main thread */
+        barrier_wait(&thread->tpool->barr[0], &thread->sense[0]);
+
+        rt_Platform *pfm = thread->tpool->pfm;
+
+        if (pfm == RT_NULL)
+        {
+            break;
+        }
+
+        rt_si32 cmd = thread->tpool->cmd;
+
+        /* if one thread throws an exception,
+         * other threads are still allowed to proceed
+         * in the same run, but not in the next one */
+        if (thread->tpool->eout == 0)
+        try
+        {
+            rt_Scene *scene = pfm->get_cur_scene();
+
+            switch (cmd & 0x3)
+            {
+                case 1:
+                scene->update_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                case 2:
+                scene->render_slice(ti, (cmd >> 2) & 0xFF);
+                break;
+
+                default:
+                break;
+            };
+        }
+        catch (rt_Exception e)
+        {
+            thread->tpool->estr[ti] = e.err;
+            thread->tpool->eout = 1;
+        }
+
+        /* every worker-thread signals to main thread when done */
+        barrier_wait(&thread->tpool->barr[1], &thread->sense[1]);
+    }
+
+    /* every worker-thread signals to main thread when done */
+    barrier_wait(&thread->tpool->barr[1], &thread->sense[1]);
+
+    return RT_NULL;
+}
+
+#if RT_SETAFFINITY
+
+/*
+ * Parse sysfs list of ranges (for instance "0-7,16-23") from "path",
+ * set entries of "map" (if not NULL) within CPU_SETSIZE to "val",
+ * return the highest entry found or -1 if the list is not present.
+ */
+static
+rt_si32 list_read(rt_astr path, rt_si32 *map, rt_si32 val)
+{
+    FILE *file = fopen(path, "r");
+    rt_si32 a, b, c, r = -1;
+
+    if (file == NULL)
+    {
+        return r;
+    }
+
+    while (fscanf(file, "%d", &a) == 1)
+    {
+        b = a;
+        c = fgetc(file);
+
+        if (c == '-' && fscanf(file, "%d", &b) == 1)
+        {
+            c = fgetc(file);
+        }
+
+        for (r = RT_MAX(r, b); a <= b && map != RT_NULL; a++)
+        {
+            if (a >= 0 && a < CPU_SETSIZE)
+            {
+                map[a] = val;
+            }
+        }
+
+        if (c != ',')
+        {
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return r;
+}
+
+/*
+ * Read NUMA node of each CPU from sysfs into "node" (CPU_SETSIZE entries),
+ * return the highest node index, all CPUs are on node 0 if not present.
+ */
+static
+rt_si32 numa_init(rt_si32 *node)
+{
+    rt_char path[64];
+    rt_si32 n, nmax = list_read("/sys/devices/system/node/possible",
+                                RT_NULL, 0);
+
+    memset(node, 0, sizeof(rt_si32) * CPU_SETSIZE);
+
+    for (n = 0; n <= nmax; n++)
+    {
+        sprintf(path, "/sys/devices/system/node/node%d/cpulist", n);
+        list_read(path, node, n);
+    }
+
+    return RT_MAX(nmax, 0);
+}
+
+/*
+ * Read CPU topology from sysfs into "key" (CPU_SETSIZE entries) for CPUs
+ * in "cpuset", CPUs sharing a physical core (mode 2) or L3 cache (mode 3)
+ * get the same key, otherwise (or if not present) each CPU is its own.
+ */
+static
+rt_void topo_init(rt_si32 *key, rt_si32 mode, cpu_set_t *cpuset)
+{
+    rt_char path[80];
+    rt_si32 a;
+
+    for (a = 0; a < CPU_SETSIZE; a++)
+    {
+        key[a] = -1;
+    }
+
+    for (a = 0; a < CPU_SETSIZE; a++)
+    {
+        if (!CPU_ISSET(a, cpuset) || key[a] >= 0)
+        {
+            continue;
+        }
+
+        if (mode == 2)
+        {
+            sprintf(path, "/sys/devices/system/cpu/cpu%d/"
+                          "topology/thread_siblings_list", a);
+        }
+        else
+        {
+            sprintf(path, "/sys/devices/system/cpu/cpu%d/"
+                          "cache/index3/level", a);
+
+            if (mode != 3 || list_read(path, RT_NULL, 0) != 3)
+            {
+                key[a] = a;
+                continue;
+            }
+
+            sprintf(path, "/sys/devices/system/cpu/cpu%d/"
+                          "cache/index3/shared_cpu_list", a);
+        }
+
+        if (list_read(path, key, a) < 0)
+        {
+            key[a] = a;
+        }
+    }
+}
+
+#endif /* RT_SETAFFINITY */
+
+/*
+ * Rethrow exception of the first failed worker-thread on the calling thread,
+ * pool's runs remain skipped by all worker-threads after that.
+ */
+static
+rt_void pool_error(rt_THREAD_POOL *tpool)
+{
+    rt_si32 i;
+
+    if (tpool->eout == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        if (tpool->estr[i] != RT_NULL)
+        {
+            throw rt_Exception(tpool->estr[i]);
+        }
+    }
+}
+
+/*
+ * Initialize pool of "thnum" threads (< 0 - no feedback) for platform "pfm",
+ * thread placement "mode": 1 - per cpu, 2 - per core, 3 - per L3-domain.
+ */
+rt_pntr pool_init(rt_si32 thnum, rt_Platform *pfm, rt_si32 mode)
+{
+    rt_bool feedback = thnum < 0 ? RT_FALSE : RT_TRUE;
+    thnum = thnum < 0 ? -thnum : thnum;
+
+#if RT_SETAFFINITY
+
+    cpu_set_t cpuset_pr, cpuset_th;
+    pthread_t pthr = pthread_self();
+    pthread_getaffinity_np(pthr, sizeof(cpu_set_t), &cpuset_pr);
+
+    /* order available CPUs by NUMA node, thus threads with adjacent
+     * indices share a node, as well as their contiguous tile-rows
+     * (per-thread memory is first touched by threads themselves) */
+    rt_si32 *order = (rt_si32 *)malloc(sizeof(rt_si32) * CPU_SETSIZE * 4);
+
+    if (order == RT_NULL)
+    {
+        throw rt_Exception("out of memory for cpu order in pool_init");
+    }
+
+    rt_si32 *cnode = order + CPU_SETSIZE * 1;
+    rt_si32 *ckey  = order + CPU_SETSIZE * 2;
+    rt_si32 *cused = order + CPU_SETSIZE * 3;
+    rt_si32 a, n, nmax = numa_init(cnode), ncpu = 0;
+
+    /* one thread per physical core or per L3 domain (mode 2, 3)
+     * takes only the first available CPU of each, thread count
+     * follows placement policy unless it is overridden */
+    topo_init(ckey, feedback ? mode : 1, &cpuset_pr);
+    memset(cused, 0, sizeof(rt_si32) * CPU_SETSIZE);
+
+    for (n = 0; n <= nmax; n++)
+    {
+        for (a = 0; a < CPU_SETSIZE; a++)
+        {
+            if (CPU_ISSET(a, &cpuset_pr) && cnode[a] == n
+            &&  cused[ckey[a]] == 0)
+            {
+                cused[ckey[a]] = 1;
+                order[ncpu++] = a;
+            }
+        }
+    }
+
+#endif /* RT_SETAFFINITY */
+
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)malloc(sizeof(rt_THREAD_POOL));
+    rt_pstr err = RT_NULL;
+
+    if (tpool == RT_NULL)
+    {
+        err = "out of memory for tpool in pool_init";
+    }
+    else
+    {
+        tpool->estr = (rt_pstr *)malloc(sizeof(rt_pstr) * thnum);
+        tpool->thread = (rt_THREAD *)malloc(sizeof(rt_THREAD) * thnum);
+
+        if (tpool->estr == RT_NULL)
+        {
+            err = "out of memory for estr in pool_init";
+        }
+        else
+        if (tpool->thread == RT_NULL)
+        {
+            err = "out of memory for thread data in pool_init";
+        }
+    }
+
+    /* release partial allocations
+     * before reporting the failure */
+    if (err != RT_NULL)
+    {
+        if (tpool != RT_NULL)
+        {
+            free(tpool->estr);
+            free(tpool->thread);
+            free(tpool);
+        }
+
+#if RT_SETAFFINITY
+
+        free(order);
+
+#endif /* RT_SETAFFINITY */
+
+        throw rt_Exception(err);
+    }
+
+    tpool->eout = 0;
+    memset(tpool->estr, 0, sizeof(rt_pstr) * thnum);
+
+    tpool->pfm = pfm;
+    tpool->cmd = -1;
+    tpool->thnum = thnum;
+
+    rt_si32 i;
+
+    for (i = 0; i < thnum; i++)
+    {
+#if RT_SETAFFINITY
+
+        if (i == ncpu && feedback)
+        {
+            thnum = i;
+            break;
+        }
+
+        a = order[i % ncpu];
+
+#endif /* RT_SETAFFINITY */
+
+        rt_THREAD *thread = tpool->thread;
+
+        thread[i].tpool = tpool;
+        thread[i].index = i;
+        thread[i].sense[0] = 0;
+        thread[i].sense[1] = 0;
+        pthread_create(&thread[i].pthr, NULL, worker_thread, &thread[i]);
+
+#if RT_SETAFFINITY
+
+        CPU_ZERO(&cpuset_th);
+        CPU_SET(a, &cpuset_th);
+        pthread_setaffinity_np(thread[i].pthr, sizeof(cpu_set_t), &cpuset_th);
+
+#endif /* RT_SETAFFINITY */
+    }
+
+#if RT_SETAFFINITY
+
+    free(order);
+
+#endif /* RT_SETAFFINITY */
+
+    barrier_init(&tpool->barr[0], thnum + 1);
+    barrier_init(&tpool->barr[1], thnum + 1);
+
+    tpool->sense[0] = 0;
+    tpool->sense[1] = 0;
+
+    if (feedback)
+    {
+        pfm->set_thnum(thnum);
+    }
+    tpool->thnum = thnum;
+    tpool->cmd = 0;
+
+    return tpool;
+}
+
+/*
+ * Return the number of threads placed by "mode" on available CPUs
+ * (1 - per cpu, 2 - per core, 3 - per L3-domain), 0 if not supported.
+ * Modes 2 and 3 place as many threads as mode 1 without topology in sysfs.
+ */
+rt_si32 pool_topo(rt_si32 mode)
+{
+#if RT_SETAFFINITY
+
+    cpu_set_t cpuset_pr;
+    pthread_t pthr = pthread_self();
+    pthread_getaffinity_np(pthr, sizeof(cpu_set_t), &cpuset_pr);
+
+    rt_si32 *ckey = (rt_si32 *)malloc(sizeof(rt_si32) * CPU_SETSIZE);
+
+    if (ckey == RT_NULL)
+    {
+        throw rt_Exception("out of memory for cpu keys in pool_topo");
+    }
+
+    rt_si32 a, ncpu = 0;
+
+    /* each placement takes the first available CPU
+     * of the group sharing its key (as in pool_init) */
+    topo_init(ckey, mode, &cpuset_pr);
+
+    for (a = 0; a < CPU_SETSIZE; a++)
+    {
+        if (CPU_ISSET(a, &cpuset_pr) && ckey[a] == a)
+        {
+            ncpu++;
+        }
+    }
+
+    free(ckey);
+
+    return ncpu;
+
+#else /* RT_SETAFFINITY */
+
+    return 0;
+
+#endif /* RT_SETAFFINITY */
+}
+
+/*
+ * Terminate pool of "thnum" threads.
+ */
+rt_void pool_term(rt_pntr tdata, rt_si32 thnum)
+{
+    rt_si32 i;
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to terminate */
+    tpool->cmd = 0;
+    tpool->pfm = RT_NULL;
+    barrier_wait(&tpool->barr[0], &tpool->sense[0]);
+    /* wait for all worker-threads to finish */
+    barrier_wait(&tpool->barr[1], &tpool->sense[1]);
+
+    for (i = 0; i < tpool->thnum; i++)
+    {
+        rt_THREAD *thread = tpool->thread;
+
+        pthread_join(thread[i].pthr, NULL);
+    }
+
+    barrier_term(&tpool->barr[0]);
+    barrier_term(&tpool->barr[1]);
+
+    free(tpool->estr);
+    free(tpool->thread);
+    free(tpool);
+}
+
+/*
+ * Task pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void pool_update(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to update scene */
+    tpool->cmd = 1 | ((phase & 0xFF) << 2);
+    barrier_wait(&tpool->barr[0], &tpool->sense[0]);
+    /* wait for all worker-threads to finish */
+    barrier_wait(&tpool->barr[1], &tpool->sense[1]);
+
+    pool_error(tpool);
+}
+
+/*
+ * Task pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void pool_render(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
+{
+    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
+
+    /* signal all worker-threads to render scene */
+    tpool->cmd = 2 | ((phase & 0xFF) << 2);
+    barrier_wait(&tpool->barr[0], &tpool->sense[0]);
+    /* wait for all worker-threads to finish */
+    barrier_wait(&tpool->barr[1], &tpool->sense[1]);
+
+    pool_error(tpool);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
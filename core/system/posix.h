@@ -0,0 +1,137 @@
+/******************************************************************************/
+/* Copyright (c) 2013-2025 VectorChief (at github, bitbucket, sourceforge)    */
+/* Distributed under the MIT software license, see the accompanying           */
+/* file COPYING or http://www.opensource.org/licenses/mit-license.php         */
+/******************************************************************************/
+
+#ifndef RT_POSIX_H
+#define RT_POSIX_H
+
+#include <pthread.h>
+
+#include "system.h"
+
+/******************************************************************************/
+/*********************************   LEGEND   *********************************/
+/******************************************************************************/
+
+/*
+ * posix.h: Interface for the POSIX platform layer.
+ *
+ * More detailed description of this subsystem is given in posix.cpp.
+ * Recommended naming scheme for C++ types and definitions is given in rtbase.h.
+ */
+
+/******************************************************************************/
+/*******************************   DEFINITIONS   ******************************/
+/******************************************************************************/
+
+/* Classes */
+
+class rt_Platform;
+
+/******************************************************************************/
+/**********************************   TIME   **********************************/
+/******************************************************************************/
+
+/*
+ * Get system time in milliseconds.
+ */
+rt_time get_time();
+
+/*
+ * Get monotonic time in microseconds.
+ */
+rt_time get_usec();
+
+/******************************************************************************/
+/**********************************   HEAP   **********************************/
+/******************************************************************************/
+
+/*
+ * Allocate memory from system heap.
+ */
+rt_pntr sys_alloc(rt_size size);
+
+/*
+ * Free memory from system heap.
+ */
+rt_void sys_free(rt_pntr ptr, rt_size size);
+
+/*
+ * Set huge-page mode for allocations of whole huge pages: 0 - off,
+ * 1 - transparent, 2 - explicit (falls back to transparent if not reserved),
+ * return the mode applied (0 if not supported).
+ */
+rt_si32 sys_huge(rt_si32 mode);
+
+/******************************************************************************/
+/*****************************   MULTI-THREADING   ****************************/
+/******************************************************************************/
+
+/* word other threads wait on to change,
+ * mutex and condition are used if futex is not present */
+struct rt_WAIT
+{
+    volatile rt_si32    word;
+    volatile rt_si32    sleep;
+    pthread_mutex_t     mutex;
+    pthread_cond_t      cond;
+};
+
+/*
+ * Initialize wait-word "wait" with value "word".
+ */
+rt_void wait_init(rt_WAIT *wait, rt_si32 word);
+
+/*
+ * Terminate wait-word "wait".
+ */
+rt_void wait_term(rt_WAIT *wait);
+
+/*
+ * Wait until wait-word differs from "word", spinning with CPU relax hint
+ * for a bounded number of iterations before sleeping on futex
+ * (or on condition variable if futex is not present).
+ */
+rt_void wait_word(rt_WAIT *wait, rt_si32 word);
+
+/*
+ * Wake threads sleeping on wait-word after it has been changed.
+ */
+rt_void wait_wake(rt_WAIT *wait);
+
+/*
+ * Initialize pool of "thnum" threads (< 0 - no feedback) for platform "pfm",
+ * thread placement "mode": 1 - per cpu, 2 - per core, 3 - per L3-domain.
+ */
+rt_pntr pool_init(rt_si32 thnum, rt_Platform *pfm, rt_si32 mode);
+
+/*
+ * Return the number of threads placed by "mode" on available CPUs
+ * (1 - per cpu, 2 - per core, 3 - per L3-domain), 0 if not supported.
+ */
+rt_si32 pool_topo(rt_si32 mode);
+
+/*
+ * Terminate pool of "thnum" threads.
+ */
+rt_void pool_term(rt_pntr tdata, rt_si32 thnum);
+
+/*
+ * Task pool of "thnum" threads to update scene,
+ * block until finished.
+ */
+rt_void pool_update(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
+
+/*
+ * Task pool of "thnum" threads to render scene,
+ * block until finished.
+ */
+rt_void pool_render(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
+
+#endif /* RT_POSIX_H */
+
+/******************************************************************************/
+/******************************************************************************/
+/******************************************************************************/
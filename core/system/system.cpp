@@ -20,6 +20,13 @@
  * System layer of the engine responsible for file I/O operations,
  * fast linear memory heap allocations, error and info logging
  * as well as definitions of List template and Exception classes.
+ *
+ * Objects allocated from the heap individually (obj_alloc) are rounded up
+ * to power-of-two size classes and kept in per-class lists of free objects
+ * within the chunk they belong to (each chunk acting as a slab), chunks with
+ * free objects are linked into per-class lists of the heap, thus alloc and
+ * free are constant-time, while release drops entire chunks along with
+ * their lists without traversing them.
  */
 
 /******************************************************************************/
@@ -152,7 +159,15 @@ rt_Heap::rt_Heap(rt_FUNC_ALLOC f_alloc, rt_FUNC_FREE f_free)
 
     /* init heap */
     head = RT_NULL;
-    obj_head = RT_NULL;
+    huge = 0;
+
+    rt_si32 k;
+
+    for (k = 0; k < RT_OBJ_CLASSES; k++)
+    {
+        obj_head[k] = RT_NULL;
+    }
+
     chunk_alloc(0, RT_ALIGN);
 }
 
@@ -164,8 +179,35 @@ rt_void rt_Heap::chunk_alloc(rt_size size, rt_ui32 align)
 {
     /* compute align and new chunk's size */
     rt_size mask = align > 0 ? align - 1 : 0;
-    rt_size real_size = size + mask + sizeof(rt_CHUNK) + (RT_CHUNK_SIZE - 1);
-    real_size = (real_size / RT_CHUNK_SIZE) * RT_CHUNK_SIZE;
+    rt_size real_size = size + mask + sizeof(rt_CHUNK);
+
+    if (huge == 0)
+    {
+        real_size += RT_CHUNK_SIZE - 1;
+        real_size = (real_size / RT_CHUNK_SIZE) * RT_CHUNK_SIZE;
+    }
+    else
+    if (real_size >= RT_CHUNK_HUGE)
+    {
+        /* big chunks are whole huge pages */
+        real_size += RT_CHUNK_HUGE - 1;
+        real_size = (real_size / RT_CHUNK_HUGE) * RT_CHUNK_HUGE;
+    }
+    else
+    {
+        /* small chunks double in size with each new chunk
+         * up to a huge page, minimizing the number of chunks */
+        rt_size class_size = head == RT_NULL ? RT_CHUNK_SIZE :
+                             RT_MIN(head->size * 2, RT_CHUNK_HUGE);
+
+        while (class_size < real_size)
+        {
+            class_size *= 2;
+        }
+
+        real_size = RT_MIN(class_size, RT_CHUNK_HUGE);
+    }
+
     rt_CHUNK *chunk = (rt_CHUNK *)f_alloc(real_size);
 
     /* check for out of memory */
@@ -181,9 +223,55 @@ rt_void rt_Heap::chunk_alloc(rt_size size, rt_ui32 align)
     chunk->size = real_size;
     chunk->next = head;
 
+    /* init chunk's lists of free objects */
+    chunk->obj_top = RT_NULL;
+
+    rt_si32 k;
+
+    for (k = 0; k < RT_OBJ_CLASSES; k++)
+    {
+        chunk->obj[k] = RT_NULL;
+        chunk->obj_next[k] = RT_NULL;
+        chunk->obj_prev[k] = RT_NULL;
+    }
+
     head = chunk;
 }
 
+/*
+ * Link "chunk" (with free objects of size class "k")
+ * to the heap's list of such chunks as head.
+ */
+rt_void rt_Heap::chunk_link(rt_CHUNK *chunk, rt_si32 k)
+{
+    chunk->obj_next[k] = obj_head[k];
+    chunk->obj_prev[k] = &obj_head[k];
+
+    if (obj_head[k] != RT_NULL)
+    {
+        obj_head[k]->obj_prev[k] = &chunk->obj_next[k];
+    }
+
+    obj_head[k] = chunk;
+}
+
+/*
+ * Unlink "chunk" (with no free objects of size class "k" left)
+ * from the heap's list of such chunks.
+ */
+rt_void rt_Heap::chunk_unlink(rt_CHUNK *chunk, rt_si32 k)
+{
+    *chunk->obj_prev[k] = chunk->obj_next[k];
+
+    if (chunk->obj_next[k] != RT_NULL)
+    {
+        chunk->obj_next[k]->obj_prev[k] = chunk->obj_prev[k];
+    }
+
+    chunk->obj_next[k] = RT_NULL;
+    chunk->obj_prev[k] = RT_NULL;
+}
+
 /*
  * Reserve given "size" bytes of memory with given "align",
  * move heap pointer ahead for the next alloc.
@@ -228,25 +316,19 @@ rt_pntr rt_Heap::reserve(rt_size size, rt_ui32 align)
  */
 rt_pntr rt_Heap::release(rt_pntr ptr)
 {
+    rt_si32 k;
+
     /* search chunk where "ptr" belongs,
      * free chunks allocated afterwards */
     while (head != RT_NULL && (ptr < head + 1 || ptr >= head->end))
     {
-        rt_pntr *obj = &obj_head;
-
-        /* traverse the list of free objects */
-        while (*obj != RT_NULL)
+        /* drop free objects of the chunk along with it */
+        for (k = 0; k < RT_OBJ_CLASSES; k++)
         {
-            /* remove free object from the chunk */
-            if (*obj >= head + 1 && *obj < head->end)
+            if (head->obj[k] != RT_NULL)
             {
-                *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
-                *obj = *(rt_pntr *)*obj; /* remove object from the list */
-                continue;
+                chunk_unlink(head, k);
             }
-
-            /* move to the next object */
-            obj = (rt_pntr *)*obj;
         }
 
         /* release chunk */
@@ -258,21 +340,36 @@ rt_pntr rt_Heap::release(rt_pntr ptr)
     /* reset heap pointer to "ptr" */
     if (head != RT_NULL && ptr >= head + 1 && ptr < head->end)
     {
-        rt_pntr *obj = &obj_head;
-
-        /* traverse the list of free objects */
-        while (*obj != RT_NULL)
+        /* traverse the lists of free objects,
+         * only if any of them is after "ptr" */
+        if (head->obj_top >= (rt_byte *)ptr)
         {
-            /* remove free object after "ptr" */
-            if (*obj >= ptr && *obj < head->end)
+            head->obj_top = RT_NULL;
+
+            for (k = 0; k < RT_OBJ_CLASSES; k++)
             {
-                *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
-                *obj = *(rt_pntr *)*obj; /* remove object from the list */
-                continue;
+                rt_pntr *obj = &head->obj[k];
+
+                while (*obj != RT_NULL)
+                {
+                    /* remove free object after "ptr" */
+                    if (*obj >= ptr)
+                    {
+                        *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
+                        *obj = *(rt_pntr *)*obj; /* remove object from list */
+                        continue;
+                    }
+
+                    /* move to the next object */
+                    head->obj_top = RT_MAX(head->obj_top, (rt_byte *)*obj);
+                    obj = (rt_pntr *)*obj;
+                }
+
+                if (head->obj[k] == RT_NULL && head->obj_prev[k] != RT_NULL)
+                {
+                    chunk_unlink(head, k);
+                }
             }
-
-            /* move to the next object */
-            obj = (rt_pntr *)*obj;
         }
 
         /* reset heap pointer */
@@ -284,50 +381,100 @@ rt_pntr rt_Heap::release(rt_pntr ptr)
     return RT_NULL;
 }
 
+/*
+ * Return the number of bytes allocated after given "ptr" was reserved,
+ * including allocs in chunks added afterwards (for sizing memory pools).
+ */
+rt_size rt_Heap::usage(rt_pntr ptr)
+{
+    rt_CHUNK *chunk;
+    rt_size size = 0;
+
+    for (chunk = head; chunk != RT_NULL; chunk = chunk->next)
+    {
+        if (ptr >= chunk + 1 && ptr < chunk->end)
+        {
+            return size + (chunk->ptr - (rt_byte *)ptr);
+        }
+
+        size += chunk->ptr - (rt_byte *)(chunk + 1);
+    }
+
+    /* chunk with "ptr" was not found */
+    return 0;
+}
+
 /*
  * Allocate given "size" bytes of memory with given "align",
  * search the list of free objects, move heap pointer otherwise.
  */
 rt_pntr rt_Heap::obj_alloc(rt_size size, rt_ui32 align)
 {
-    rt_pntr *obj = &obj_head;
+    rt_CHUNK *chunk;
+    rt_si32 k = 0;
 
     /* each object must be capable of holding a pointer */
     size = RT_MAX(size, 8);
 
-    /* search the list of free objects */
-    while (*obj != RT_NULL)
+    /* round size up to its class,
+     * bigger objects share the last class */
+    while (k < RT_OBJ_CLASSES - 1 && ((rt_size)8 << k) < size)
+    {
+        k++;
+    }
+
+    size = RT_MAX(size, (rt_size)8 << k);
+
+    /* search chunks with free objects of the class,
+     * first one fits unless align or size differs */
+    for (chunk = obj_head[k]; chunk != RT_NULL; chunk = chunk->obj_next[k])
     {
-        /* compute align */
-        rt_size mask = align > 0 ? align - 1 : 0;
-        rt_byte *real_ptr = (rt_byte *)(((rt_size)*obj + mask) & ~mask);
-        rt_si32 real_size = *((rt_si32 *)*obj - 1); /* fetch size from obj */
-        real_size -= (rt_si32)(real_ptr - (rt_byte *)*obj); /* size-=align */
-
-        /* found matching object */                  /* check 1-FREE-OBJ */
-        if (real_size >= size && *((rt_si32 *)*obj - 2) == 0x1F3EE0B7)
+        rt_pntr *obj = &chunk->obj[k];
+
+        while (*obj != RT_NULL)
         {
-            *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
-            *obj = *(rt_pntr *)*obj; /* remove object from the list */
+            /* compute align */
+            rt_size mask = align > 0 ? align - 1 : 0;
+            rt_byte *real_ptr = (rt_byte *)(((rt_size)*obj + mask) & ~mask);
+            rt_si32 real_size = *((rt_si32 *)*obj - 1); /* fetch obj's size */
+            real_size -= (rt_si32)(real_ptr - (rt_byte *)*obj); /* -= align */
+
+            /* found matching object */              /* check 1-FREE-OBJ */
+            if (real_size >= (rt_si32)size &&
+                *((rt_si32 *)*obj - 2) == 0x1F3EE0B7)
+            {
+                *((rt_si32 *)*obj - 2) = 0; /* clear object's "magic" */
+                *obj = *(rt_pntr *)*obj; /* remove object from the list */
 
-            *((rt_si32 *)real_ptr - 1) = real_size; /* size behind pointer */
-            *((rt_si32 *)real_ptr - 2) = 0x1600D0B7; /* stamp 1-GODD-OBJ */
+                if (chunk->obj[k] == RT_NULL)
+                {
+                    chunk_unlink(chunk, k);
+                }
 
-            return real_ptr;
-        }
+                *((rt_si32 *)real_ptr - 1) = real_size; /* size behind ptr */
+                *((rt_si32 *)real_ptr - 2) = 0x1600D0B7; /* stamp 1-GODD-OBJ */
+                *((rt_CHUNK **)((rt_si32 *)real_ptr - 2) - 1) = chunk;
 
-        /* move to the next object */
-        obj = (rt_pntr *)*obj;
+                return real_ptr;
+            }
+
+            /* move to the next object */
+            obj = (rt_pntr *)*obj;
+        }
     }
 
-    rt_byte *ptr = (rt_byte *)reserve(size + RT_MAX(8, align), align);
+    /* object's header holds its chunk, "magic" and size */
+    rt_size head_size = RT_MAX(8 + sizeof(rt_CHUNK *), align);
 
-    head->ptr = ptr + size + RT_MAX(8, align);
+    rt_byte *ptr = (rt_byte *)reserve(size + head_size, align);
 
-    ptr += RT_MAX(8, align);
+    head->ptr = ptr + size + head_size;
 
-    *((rt_si32 *)ptr - 1) = size;      /* size behind pointer */
+    ptr += head_size;
+
+    *((rt_si32 *)ptr - 1) = (rt_si32)size; /* size behind pointer */
     *((rt_si32 *)ptr - 2) = 0x1600D0B7; /* stamp 1-GODD-OBJ */
+    *((rt_CHUNK **)((rt_si32 *)ptr - 2) - 1) = head;
 
     return ptr;
 }
@@ -343,9 +490,27 @@ rt_pntr rt_Heap::obj_free(rt_pntr ptr)
     {
         *((rt_si32 *)ptr - 2)  = 0x1F3EE0B7; /* stamp 1-FREE-OBJ */
 
-        /* add object to the list */
-        *(rt_pntr *)ptr = obj_head;
-        obj_head = ptr;
+        rt_CHUNK *chunk = *((rt_CHUNK **)((rt_si32 *)ptr - 2) - 1);
+        rt_size size = *((rt_si32 *)ptr - 1);
+        rt_si32 k = RT_OBJ_CLASSES - 1;
+
+        /* find the class object's size fully covers,
+         * bigger objects share the last class */
+        while (k > 0 && ((rt_size)8 << k) > size)
+        {
+            k--;
+        }
+
+        /* add object to the chunk's list */
+        if (chunk->obj[k] == RT_NULL)
+        {
+            chunk_link(chunk, k);
+        }
+
+        *(rt_pntr *)ptr = chunk->obj[k];
+        chunk->obj[k] = ptr;
+
+        chunk->obj_top = RT_MAX(chunk->obj_top, (rt_byte *)ptr);
         return ptr;
     }
 
@@ -353,19 +518,33 @@ rt_pntr rt_Heap::obj_free(rt_pntr ptr)
     return RT_NULL;
 }
 
+/*
+ * Set chunk size classes for new chunks: 0 - heap allocation granularity,
+ * 1 - doubling up to a huge page, then whole huge pages (for system allocators
+ * backing such chunks with huge pages), return the mode applied.
+ */
+rt_si32 rt_Heap::set_huge(rt_si32 huge)
+{
+    this->huge = huge != 0 ? 1 : 0;
+
+    return this->huge;
+}
+
+/*
+ * Get chunk size classes.
+ */
+rt_si32 rt_Heap::get_huge()
+{
+    return huge;
+}
+
 /*
  * Deinitialize heap.
  */
 rt_Heap::~rt_Heap()
 {
-    /* release all free objects from the list */
-    while (obj_head != RT_NULL)
-    {
-        *((rt_si32 *)obj_head - 2) = 0; /* clear object's "magic" */
-        obj_head = *(rt_pntr *)obj_head; /* remove object from the list */
-    }
-
-    /* free all chunks from the list */
+    /* free all chunks from the list,
+     * free objects are dropped along with them */
     while (head != RT_NULL)
     {
         rt_CHUNK *chunk = head->next;
@@ -30,6 +30,9 @@
 /******************************************************************************/
 
 #define RT_CHUNK_SIZE           65536 /* heap allocation granularity (16*4k) */
+#define RT_CHUNK_HUGE         2097152 /* heap chunk classes limit (huge page) */
+
+#define RT_OBJ_CLASSES          16 /* object size classes (8 bytes to 256k) */
 
 #define RT_PATH_STRFY(p)        #p
 #define RT_PATH_TOSTR(p)        RT_PATH_STRFY(p)
@@ -38,6 +41,24 @@
 #define RT_PATH_DUMP_LOG        RT_PATH_TOSTR(RT_PATH)"dump/log.txt"
 #define RT_PATH_DUMP_ERR        RT_PATH_TOSTR(RT_PATH)"dump/err.txt"
 
+/*
+ * Atomic fetch-and-add on a 32-bit integer,
+ * returns the value prior to the increment.
+ */
+#if   (defined RT_WIN32) /* Win32, MSVC -------- for older versions --------- */
+
+#include <intrin.h>
+
+#define RT_ATOMIC_ADD(p, v)                                                 \
+        _InterlockedExchangeAdd((volatile long *)(p), (long)(v))
+
+#else /* --- Win64, GCC --- Linux, GCC -------------------------------------- */
+
+#define RT_ATOMIC_ADD(p, v)                                                 \
+        __sync_fetch_and_add((p), (v))
+
+#endif /* ------------- OS specific ----------------------------------------- */
+
 /* Classes */
 
 class rt_File;
@@ -88,7 +109,8 @@ class rt_File
 /******************************************************************************/
 
 /*
- * Memory chunk header structure.
+ * Memory chunk header structure,
+ * holds free lists of objects per size class.
  */
 struct rt_CHUNK
 {
@@ -96,6 +118,15 @@ struct rt_CHUNK
     rt_byte            *end;
     rt_size             size;
     rt_CHUNK           *next;
+
+    /* highest free object */
+    rt_byte            *obj_top;
+    rt_pntr             obj[RT_OBJ_CLASSES];
+
+    /* links in heap's per-class lists
+     * of chunks holding free objects */
+    rt_CHUNK           *obj_next[RT_OBJ_CLASSES];
+    rt_CHUNK          **obj_prev[RT_OBJ_CLASSES];
 };
 
 /*
@@ -115,9 +146,17 @@ class rt_Heap
     private:
 
     rt_CHUNK           *head;
-    rt_pntr             obj_head;
+
+    /* chunks holding free objects
+     * per size class */
+    rt_CHUNK           *obj_head[RT_OBJ_CLASSES];
+
+    /* chunk size classes */
+    rt_si32             huge;
 
     rt_void chunk_alloc(rt_size size, rt_ui32 align);
+    rt_void chunk_link(rt_CHUNK *chunk, rt_si32 k);
+    rt_void chunk_unlink(rt_CHUNK *chunk, rt_si32 k);
 
     protected:
 
@@ -136,9 +175,13 @@ class rt_Heap
     rt_pntr alloc(rt_size size, rt_ui32 align);
     rt_pntr reserve(rt_size size, rt_ui32 align);
     rt_pntr release(rt_pntr ptr);
+    rt_size usage(rt_pntr ptr);
 
     rt_pntr obj_alloc(rt_size size, rt_ui32 align);
     rt_pntr obj_free(rt_pntr ptr);
+
+    rt_si32 set_huge(rt_si32 huge); /* 0 - off, 1 - huge page classes */
+    rt_si32 get_huge();
 };
 
 /******************************************************************************/
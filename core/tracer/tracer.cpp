@@ -57,6 +57,7 @@
 #define RT_FEAT_LIGHTS_COLORED      1
 #define RT_FEAT_LIGHTS_AMBIENT      1
 #define RT_FEAT_LIGHTS_SHADOWS      1
+#define RT_FEAT_LIGHTS_SHADOWS_OCC  1   /* test last occluder of light first */
 #define RT_FEAT_LIGHTS_DIFFUSE      1
 #define RT_FEAT_LIGHTS_ATTENUATION  1
 #define RT_FEAT_LIGHTS_SPECULAR     1
@@ -538,6 +539,26 @@
 
 #define RT_FLAG_SHAD            4
 
+/*
+ * Count secondary ray packet of kind "cn" (RT_PROFILE),
+ * track the deepest level reached by the packet for the heatmap.
+ */
+#if RT_PROFILE
+
+#define COUNT_RAYS(cn) /* destroys Reax */                                  \
+        addxx_mi(Mebp, inf_CNT_##cn, IB(1))                                 \
+        movxx_ld(Reax, Mebp, inf_DEPTH)                                     \
+        cmjxx_rm(Reax, Mebp, inf_HMP_D,                                     \
+                 GE_x, 100501f)                                             \
+        movxx_st(Reax, Mebp, inf_HMP_D)                                     \
+    LBL(100501)
+
+#else /* RT_PROFILE */
+
+#define COUNT_RAYS(cn)
+
+#endif /* RT_PROFILE */
+
 /*
  * Check if flag "fl" is set in the context's field "pl",
  * jump to "lb" otherwise.
@@ -566,6 +587,39 @@
                  EQ_x, lo)                                                  \
     LBL(100501)
 
+/*
+ * Save current surface's list element as the last occluder
+ * for the shadow list of the light being traced, unless surface
+ * depends on its trnode (shifted axis mapping), as the cached copy
+ * is tested out of the list's order before the whole list.
+ */
+#if RT_FEAT_LIGHTS_SHADOWS_OCC
+
+#define CHECK_OCCL() /* destroys Reax */                                  \
+        cmjwx_mi(Mebx, srf_A_MAP(RT_I*4), IM(Q*0x30),                       \
+                 GE_x, 100505f)                                             \
+        stack_st(Rebx)                                                      \
+        movxx_ld(Rebx, Mebp, inf_OCC)                                       \
+        movxx_ld(Reax, Mecx, ctx_PARAM(LST))                                \
+        shrxx_ri(Reax, IB(3+P))                                             \
+        andxx_ri(Reax, IB(RT_OCC_SLOTS - 1))                                \
+        shlxx_ri(Reax, IB(3+P))                                             \
+        addxx_rr(Rebx, Reax)                                                \
+        movxx_ld(Reax, Mecx, ctx_PARAM(LST))                                \
+        movxx_st(Reax, Mebx, elm_TEMP)                                      \
+        movxx_ld(Reax, Mesi, elm_DATA)                                      \
+        movxx_st(Reax, Mebx, elm_DATA)                                      \
+        movxx_ld(Reax, Mesi, elm_SIMD)                                      \
+        movxx_st(Reax, Mebx, elm_SIMD)                                      \
+        stack_ld(Rebx)                                                      \
+    LBL(100505)
+
+#else /* RT_FEAT_LIGHTS_SHADOWS_OCC */
+
+#define CHECK_OCCL()
+
+#endif /* RT_FEAT_LIGHTS_SHADOWS_OCC */
+
 /*
  * Check if ray is a shadow ray, then check
  * material properties to see if shadow is applicable.
@@ -585,6 +639,10 @@
                  EQ_x, 510134b) /* SR_rt4 */                                \
         cmjwx_ri(Reax, IB(6),                                               \
                  EQ_x, 510136b) /* SR_rt6 */                                \
+        cmjwx_ri(Reax, IB(13),                                              \
+                 EQ_x, 5101313b) /* SR_rt13 */                              \
+        cmjwx_ri(Reax, IB(14),                                              \
+                 EQ_x, 5101314b) /* SR_rt14 */                              \
     LBL(100502)                                                             \
         CHECK_PROP(100503f, RT_PROP_TRANSP)                                 \
         CHECK_PROP(100504f, RT_PROP_REFRACT)                                \
@@ -599,10 +657,15 @@
                  EQ_x, 510134b) /* SR_rt4 */                                \
         cmjwx_ri(Reax, IB(6),                                               \
                  EQ_x, 510136b) /* SR_rt6 */                                \
+        cmjwx_ri(Reax, IB(13),                                              \
+                 EQ_x, 5101313b) /* SR_rt13 */                              \
+        cmjwx_ri(Reax, IB(14),                                              \
+                 EQ_x, 5101314b) /* SR_rt14 */                              \
     LBL(100503)                                                             \
         movpx_ld(Xmm7, Mecx, ctx_C_BUF(0))                                  \
         orrpx_ld(Xmm7, Mecx, ctx_TMASK(0))                                  \
         movpx_st(Xmm7, Mecx, ctx_C_BUF(0))                                  \
+        CHECK_OCCL()                                                      \
         CHECK_MASK(990923f, FULL, Xmm7)         /* OO_out */                \
         movwx_ld(Reax, Mecx, ctx_LOCAL(PTR))                                \
         cmjwx_ri(Reax, IB(1),                                               \
@@ -613,6 +676,10 @@
                  EQ_x, 510134b) /* SR_rt4 */                                \
         cmjwx_ri(Reax, IB(6),                                               \
                  EQ_x, 510136b) /* SR_rt6 */                                \
+        cmjwx_ri(Reax, IB(13),                                              \
+                 EQ_x, 5101313b) /* SR_rt13 */                              \
+        cmjwx_ri(Reax, IB(14),                                              \
+                 EQ_x, 5101314b) /* SR_rt14 */                              \
     LBL(100501)
 
 /*
@@ -2144,7 +2211,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNDX)
+        movxx_ld(Reax, Mebp, inf_FRM_I)
         movxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -2188,6 +2255,53 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #endif /* RT_FEAT_BUFFERS */
 
+#if RT_FEAT_PT && RT_FEAT_BUFFERS
+
+        cmjxx_mz(Mebp, inf_PT_ON,
+                 EQ_x, 770134f) /* YY_cnt */
+
+        /* scale fp-color planes for the rows of
+         * pixel blocks at once, as SIMD lanes of
+         * a block don't form a contiguous span */
+        movxx_ld(Rebx, Mebp, inf_FSAA)
+
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        addxx_ld(Reax, Mebp, inf_BLK_H)
+        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
+        shlxx_ri(Reax, IB(L+1))
+        shlxx_rr(Reax, Rebx)
+        movxx_rr(Resi, Reax)
+
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
+        shlxx_ri(Reax, IB(L+1))
+        shlxx_rr(Reax, Rebx)
+
+    LBL(770234) /* YY_pts */
+
+        movxx_ld(Rebx, Mebp, inf_PTR_R)
+        movpx_ld(Xmm0, Iebx, DP(0))
+        mulps_ld(Xmm0, Mebp, inf_PTS_U)
+        movpx_st(Xmm0, Iebx, DP(0))
+
+        movxx_ld(Rebx, Mebp, inf_PTR_G)
+        movpx_ld(Xmm0, Iebx, DP(0))
+        mulps_ld(Xmm0, Mebp, inf_PTS_U)
+        movpx_st(Xmm0, Iebx, DP(0))
+
+        movxx_ld(Rebx, Mebp, inf_PTR_B)
+        movpx_ld(Xmm0, Iebx, DP(0))
+        mulps_ld(Xmm0, Mebp, inf_PTS_U)
+        movpx_st(Xmm0, Iebx, DP(0))
+
+        addxx_ri(Reax, IM(RT_SIMD_QUADS*16))
+        cmjxx_rr(Reax, Resi,
+                 LT_x, 770234b) /* YY_pts */
+
+    LBL(770134) /* YY_cnt */
+
+#endif /* RT_FEAT_PT && RT_FEAT_BUFFERS */
+
 /******************************************************************************/
 /********************************   HOR INIT   ********************************/
 /******************************************************************************/
@@ -2239,29 +2353,6 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movpx_ld(Xmm0, Oeax, PLAIN)             /* tmp_v <- PRNGS */
         movpx_st(Xmm0, Mecx, ctx_C_BUF(0))      /* tmp_v -> C_BUF */
 
-        movxx_ld(Rebx, Mebp, inf_FSAA)
-
-        movxx_ld(Reax, Mebp, inf_FRM_Y)
-        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
-        addxx_ld(Reax, Mebp, inf_FRM_X)
-        shlxx_ri(Reax, IB(L+1))
-        shlxx_rr(Reax, Rebx)
-
-        movxx_ld(Rebx, Mebp, inf_PTR_R)
-        movpx_ld(Xmm0, Iebx, DP(0))
-        mulps_ld(Xmm0, Mebp, inf_PTS_U)
-        movpx_st(Xmm0, Iebx, DP(0))
-
-        movxx_ld(Rebx, Mebp, inf_PTR_G)
-        movpx_ld(Xmm0, Iebx, DP(0))
-        mulps_ld(Xmm0, Mebp, inf_PTS_U)
-        movpx_st(Xmm0, Iebx, DP(0))
-
-        movxx_ld(Rebx, Mebp, inf_PTR_B)
-        movpx_ld(Xmm0, Iebx, DP(0))
-        mulps_ld(Xmm0, Mebp, inf_PTS_U)
-        movpx_st(Xmm0, Iebx, DP(0))
-
 #endif /* RT_FEAT_BUFFERS */
 
 #if RT_FEAT_PT_RANDOM_SAMPLE
@@ -2410,6 +2501,18 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movpx_st(Xmm2, Mecx, ctx_RAY_Y(0))      /* ray_y -> RAY_Y */
         movpx_st(Xmm3, Mecx, ctx_RAY_Z(0))      /* ray_z -> RAY_Z */
 
+#if RT_PROFILE
+
+        addxx_mi(Mebp, inf_CNT_PRM, IB(1))
+
+        /* reset per-packet heatmap cost */
+        movxx_mi(Mebp, inf_HMP_E, IB(0))
+        movxx_mi(Mebp, inf_HMP_S, IB(0))
+        movxx_ld(Reax, Mebp, inf_DEPTH)
+        movxx_st(Reax, Mebp, inf_HMP_D)
+
+#endif /* RT_PROFILE */
+
 /******************************************************************************/
 /********************************   OBJ LIST   ********************************/
 /******************************************************************************/
@@ -2438,6 +2541,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
         movxx_ld(Rebx, Mesi, elm_SIMD)
 
+#if RT_PROFILE
+
+        addxx_mi(Mebp, inf_HMP_E, IB(1))
+
+#endif /* RT_PROFILE */
+
         /* use local (potentially adjusted)
          * hit point (from unused normal fields)
          * as local diff for secondary rays
@@ -2672,12 +2781,26 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #endif /* RT_FEAT_TRANSFORM_ARRAY */
 
+#if RT_PROFILE
+
+        /* count root-solver invocations per surface tag,
+         * trnode elements are skipped above */
+        movwx_ld(Reax, Mebx, srf_SRF_T(TAG))
+        shlxx_ri(Reax, IB(1+P))
+        addxx_mi(Iebp, inf_CNT_SRF, IB(1))
+        addxx_mi(Mebp, inf_HMP_S, IB(1))
+        movwx_ld(Reax, Mebx, srf_SRF_T(PTR))
+
+#endif /* RT_PROFILE */
+
         cmjwx_ri(Reax, IB(1),
                  EQ_x, 220231f) /* PL_ptr */
         cmjwx_ri(Reax, IB(2),
                  EQ_x, 880231f) /* QD_ptr */
         cmjwx_ri(Reax, IB(3),
                  EQ_x, 320231f) /* TP_ptr */
+        cmjwx_ri(Reax, IB(4),
+                 EQ_x, 360231f) /* MG_ptr */
 
 /******************************************************************************/
 /********************************   CLIPPING   ********************************/
@@ -3223,6 +3346,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
                  EQ_x, 880622f) /* QD_clp */
         cmjwx_ri(Reax, IB(3),
                  EQ_x, 320622f) /* TP_clp */
+        cmjwx_ri(Reax, IB(4),
+                 EQ_x, 660598f) /* CC_end */    /* mesh isn't a clipper */
 
     LBL(660153) /* CC_ret */
 
@@ -3247,6 +3372,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
                  EQ_x, 510133f) /* SR_rt3 */
         cmjwx_ri(Reax, IB(5),
                  EQ_x, 510135f) /* SR_rt5 */
+        cmjwx_ri(Reax, IB(12),
+                 EQ_x, 5101312f) /* SR_rt12 */
 
 /******************************************************************************/
 /********************************   MATERIAL   ********************************/
@@ -3749,8 +3876,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         orrxx_ri(Reax, IB(RT_FLAG_PASS_BACK))
         addxx_ri(Recx, IH(RT_STACK_STEP))
         subxx_mi(Mebp, inf_DEPTH, IB(1))
-
         movxx_st(Reax, Mecx, ctx_PARAM(FLG))    /* context flags */
+        COUNT_RAYS(PTH) /* destroys Reax */
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(4))   /* mark PT_ret with tag 4 */
@@ -4051,8 +4178,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         orrxx_ri(Reax, IB(RT_FLAG_PASS_BACK | RT_FLAG_SHAD))
         addxx_ri(Recx, IH(RT_STACK_STEP))
         subxx_mi(Mebp, inf_DEPTH, IB(1))
-
         movxx_st(Reax, Mecx, ctx_PARAM(FLG))    /* context flags */
+        COUNT_RAYS(SHD) /* destroys Reax */
         movxx_st(Redi, Mecx, ctx_PARAM(LST))    /* save light/shadow list */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(1))   /* mark LT_ret with tag 1 */
@@ -4072,6 +4199,28 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         movpx_st(Xmm0, Mecx, ctx_LOCAL(-C/2 + RT_SIMD_QUADS*8))
 
         movxx_ld(Resi, Medi, elm_DATA)          /* load shadow list */
+
+#if RT_FEAT_LIGHTS_SHADOWS_OCC
+
+        /* if the last occluder is cached for the shadow list,
+         * prepend its copy to the list to be tested first,
+         * coherent rays are likely to be blocked by it again */
+        movxx_ld(Rebx, Mebp, inf_OCC)
+        movxx_rr(Reax, Redi)
+        shrxx_ri(Reax, IB(3+P))
+        andxx_ri(Reax, IB(RT_OCC_SLOTS - 1))
+        shlxx_ri(Reax, IB(3+P))
+        addxx_rr(Rebx, Reax)
+        cmjxx_rm(Redi, Mebx, elm_TEMP,
+                 NE_x, 230635f) /* LT_occ */
+
+        movxx_st(Resi, Mebx, elm_NEXT)
+        movxx_rr(Resi, Rebx)
+
+    LBL(230635) /* LT_occ */
+
+#endif /* RT_FEAT_LIGHTS_SHADOWS_OCC */
+
         jmpxx_lb(990676b) /* OO_cyc */
 
     LBL(230153) /* LT_ret */
@@ -4822,8 +4971,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         orrxx_ri(Reax, IB(RT_FLAG_PASS_THRU))
         addxx_ri(Recx, IH(RT_STACK_STEP))
         subxx_mi(Mebp, inf_DEPTH, IB(1))
-
         movxx_st(Reax, Mecx, ctx_PARAM(FLG))    /* context flags */
+        COUNT_RAYS(RFR) /* destroys Reax */
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(3))   /* mark TR_ret with tag 3 */
@@ -5237,8 +5386,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         orrxx_ri(Reax, IB(RT_FLAG_PASS_BACK))
         addxx_ri(Recx, IH(RT_STACK_STEP))
         subxx_mi(Mebp, inf_DEPTH, IB(1))
-
         movxx_st(Reax, Mecx, ctx_PARAM(FLG))    /* context flags */
+        COUNT_RAYS(RFL) /* destroys Reax */
         movxx_st(Redx, Mecx, ctx_PARAM(LST))    /* save material */
         movxx_st(Rebx, Mecx, ctx_PARAM(OBJ))    /* originating surface */
         movwx_mi(Mecx, ctx_PARAM(PTR), IB(2))   /* mark RF_ret with tag 2 */
@@ -5400,6 +5549,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
     LBL(510134) /* SR_rt4 *//* dummy target for CHECK_SHAD in PL */
     LBL(510136) /* SR_rt6 *//* dummy target for CHECK_SHAD in PL */
+    LBL(5101313) /* SR_rt13 *//* dummy target for CHECK_SHAD in PL */
+    LBL(5101314) /* SR_rt14 *//* dummy target for CHECK_SHAD in PL */
 
         cmjwx_ri(Reax, IB(1),
                  EQ_x, 510131f) /* SR_rt1 */
@@ -5409,6 +5560,10 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
                  EQ_x, 510134f) /* SR_rt4 */
         cmjwx_ri(Reax, IB(6),
                  EQ_x, 510136f) /* SR_rt6 */
+        cmjwx_ri(Reax, IB(13),
+                 EQ_x, 5101313f) /* SR_rt13 */
+        cmjwx_ri(Reax, IB(14),
+                 EQ_x, 5101314f) /* SR_rt14 */
 
 /******************************************************************************/
 /**********************************   ARRAY   *********************************/
@@ -5418,6 +5573,12 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
     LBL(510231) /* AR_ptr */
 
+#if RT_PROFILE
+
+        addxx_mi(Mebp, inf_CNT_BVT, IB(1))
+
+#endif /* RT_PROFILE */
+
         movwx_ld(Reax, Mebx, srf_A_SGN(RT_L*4)) /* Reax is used in Iecx */
 
         /* "x" section */
@@ -6222,6 +6383,8 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
                  EQ_x, 880353f) /* QD_mat */
         cmjwx_ri(Reax, IB(3),
                  EQ_x, 320353f) /* TP_mat */
+        cmjwx_ri(Reax, IB(4),
+                 EQ_x, 360353f) /* MG_mat */
 
 /******************************************************************************/
     LBL(880353) /* QD_mat */
@@ -6496,6 +6659,562 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #endif /* RT_FEAT_CLIPPING_CUSTOM */
 
+/******************************************************************************/
+/**********************************   MESH   **********************************/
+/******************************************************************************/
+
+    LBL(360231) /* MG_ptr */
+
+#if RT_SHOW_TILES
+
+        SHOW_TILES(MG, 0x00444488)
+
+#endif /* RT_SHOW_TILES */
+
+        movwx_ld(Reax, Mebx, srf_A_SGN(RT_L*4)) /* Reax is used in Iecx */
+
+        /* use context's normal fields (NRM)
+         * as temporary storage for traversal */
+        movpx_ld(Xmm1, Iecx, ctx_RAY_X(0))      /* ray_x <- RAY_X */
+        movpx_ld(Xmm4, Mebp, inf_GPC01)         /* inv_x <- +1.0f */
+        divps_rr(Xmm4, Xmm1)                    /* inv_x /= ray_x */
+        movpx_st(Xmm4, Mecx, ctx_NRM_X)         /* inv_x -> NRM_X */
+
+        movpx_ld(Xmm2, Iecx, ctx_RAY_Y(0))      /* ray_y <- RAY_Y */
+        movpx_ld(Xmm5, Mebp, inf_GPC01)         /* inv_y <- +1.0f */
+        divps_rr(Xmm5, Xmm2)                    /* inv_y /= ray_y */
+        movpx_st(Xmm5, Mecx, ctx_NRM_Y)         /* inv_y -> NRM_Y */
+
+        movpx_ld(Xmm3, Iecx, ctx_RAY_Z(0))      /* ray_z <- RAY_Z */
+        movpx_ld(Xmm6, Mebp, inf_GPC01)         /* inv_z <- +1.0f */
+        divps_rr(Xmm6, Xmm3)                    /* inv_z /= ray_z */
+        movpx_st(Xmm6, Mecx, ctx_NRM_Z)         /* inv_z -> NRM_Z */
+
+        /* secondary rays originating from the mesh
+         * skip its self-hit range (T_EPS) along the ray */
+        movpx_ld(Xmm7, Mecx, ctx_T_MIN)         /* t_min <- T_MIN */
+        cmjxx_rm(Rebx, Mecx, ctx_PARAM(OBJ),
+                 NE_x, 360155f) /* MG_tlo */
+
+        mulps_rr(Xmm1, Xmm1)                    /* ray_x *= ray_x */
+        mulps_rr(Xmm2, Xmm2)                    /* ray_y *= ray_y */
+        mulps_rr(Xmm3, Xmm3)                    /* ray_z *= ray_z */
+        addps_rr(Xmm1, Xmm2)                    /* ry2_x += ry2_y */
+        addps_rr(Xmm1, Xmm3)                    /* ry2_t += ry2_z */
+        rsqps_rr(Xmm0, Xmm1) /* destroys Xmm1 *//* inv_r rs ray_r */
+        mulps_ld(Xmm0, Mebx, srf_T_EPS)         /* inv_r *= T_EPS */
+        maxps_rr(Xmm7, Xmm0)                    /* t_min mx inv_r */
+
+    LBL(360155) /* MG_tlo */
+
+        movpx_st(Xmm7, Mecx, ctx_XTMP1)         /* t_min -> XTMP1 */
+        movpx_ld(Xmm0, Mecx, ctx_T_BUF(0))      /* t_buf <- T_BUF */
+        movpx_st(Xmm0, Mecx, ctx_T_VAL(0))      /* t_buf -> T_VAL */
+
+        /* use next context's RAY fields (NEW)
+         * of the other axis set as temporary storage
+         * for the nearest hit's normal during traversal */
+        movxx_ld(Redx, Mebx, srf_MSH_P(PTR))    /* load bvh's root node */
+        stack_st(Resi)
+        movxx_rr(Resi, Recx)
+        addxx_ri(Resi, IH(Q*0x30))
+        subxx_rr(Resi, Reax)
+        movxx_rr(Rebx, Recx)
+        addxx_rr(Rebx, Reax)
+
+/******************************************************************************/
+    LBL(360676) /* MG_cyc */
+
+        /* "x" section */
+        movpx_ld(Xmm0, Medx, msh_MIN_X)         /* t_nrx <- MIN_X */
+        subps_ld(Xmm0, Mebx, ctx_DFF_X)         /* t_nrx -= DFF_X */
+        mulps_ld(Xmm0, Mecx, ctx_NRM_X)         /* t_nrx *= inv_x */
+        movpx_ld(Xmm1, Medx, msh_MAX_X)         /* t_frx <- MAX_X */
+        subps_ld(Xmm1, Mebx, ctx_DFF_X)         /* t_frx -= DFF_X */
+        mulps_ld(Xmm1, Mecx, ctx_NRM_X)         /* t_frx *= inv_x */
+        movpx_rr(Xmm2, Xmm0)                    /* t_tmp <- t_nrx */
+        minps_rr(Xmm0, Xmm1)                    /* t_nrx mn t_frx */
+        maxps_rr(Xmm1, Xmm2)                    /* t_frx mx t_tmp */
+
+        /* "y" section */
+        movpx_ld(Xmm2, Medx, msh_MIN_Y)         /* t_nry <- MIN_Y */
+        subps_ld(Xmm2, Mebx, ctx_DFF_Y)         /* t_nry -= DFF_Y */
+        mulps_ld(Xmm2, Mecx, ctx_NRM_Y)         /* t_nry *= inv_y */
+        movpx_ld(Xmm3, Medx, msh_MAX_Y)         /* t_fry <- MAX_Y */
+        subps_ld(Xmm3, Mebx, ctx_DFF_Y)         /* t_fry -= DFF_Y */
+        mulps_ld(Xmm3, Mecx, ctx_NRM_Y)         /* t_fry *= inv_y */
+        movpx_rr(Xmm4, Xmm2)                    /* t_tmp <- t_nry */
+        minps_rr(Xmm2, Xmm3)                    /* t_nry mn t_fry */
+        maxps_rr(Xmm3, Xmm4)                    /* t_fry mx t_tmp */
+        maxps_rr(Xmm0, Xmm2)                    /* t_nrx mx t_nry */
+        minps_rr(Xmm1, Xmm3)                    /* t_frx mn t_fry */
+
+        /* "z" section */
+        movpx_ld(Xmm2, Medx, msh_MIN_Z)         /* t_nrz <- MIN_Z */
+        subps_ld(Xmm2, Mebx, ctx_DFF_Z)         /* t_nrz -= DFF_Z */
+        mulps_ld(Xmm2, Mecx, ctx_NRM_Z)         /* t_nrz *= inv_z */
+        movpx_ld(Xmm3, Medx, msh_MAX_Z)         /* t_frz <- MAX_Z */
+        subps_ld(Xmm3, Mebx, ctx_DFF_Z)         /* t_frz -= DFF_Z */
+        mulps_ld(Xmm3, Mecx, ctx_NRM_Z)         /* t_frz *= inv_z */
+        movpx_rr(Xmm4, Xmm2)                    /* t_tmp <- t_nrz */
+        minps_rr(Xmm2, Xmm3)                    /* t_nrz mn t_frz */
+        maxps_rr(Xmm3, Xmm4)                    /* t_frz mx t_tmp */
+        maxps_rr(Xmm0, Xmm2)                    /* t_nrx mx t_nrz */
+        minps_rr(Xmm1, Xmm3)                    /* t_frx mn t_frz */
+
+        /* create bmask */
+        maxps_ld(Xmm0, Mecx, ctx_XTMP1)         /* t_nrx mx t_min */
+        minps_ld(Xmm1, Mecx, ctx_T_VAL(0))      /* t_frx mn T_VAL */
+        cleps_rr(Xmm0, Xmm1)                    /* t_nrx <= t_frx */
+        andpx_ld(Xmm0, Mecx, ctx_WMASK)         /* bmask &= WMASK */
+        CHECK_MASK(360635f, NONE, Xmm0)         /* MG_mis */
+
+        /* inner nodes have no triangles */
+        movxx_ld(Redi, Medx, msh_TRI_P(PTR))
+        cmjxx_rz(Redi,
+                 EQ_x, 360638f) /* MG_nxt */
+
+/******************************************************************************/
+    LBL(360177) /* MG_tri */
+
+        /* "tv" section */
+        movpx_ld(Xmm1, Mebx, ctx_DFF_X)         /* tvc_x <- DFF_X */
+        subps_ld(Xmm1, Medi, tri_VER_X)         /* tvc_x -= VER_X */
+        movpx_ld(Xmm2, Mebx, ctx_DFF_Y)         /* tvc_y <- DFF_Y */
+        subps_ld(Xmm2, Medi, tri_VER_Y)         /* tvc_y -= VER_Y */
+        movpx_ld(Xmm3, Mebx, ctx_DFF_Z)         /* tvc_z <- DFF_Z */
+        subps_ld(Xmm3, Medi, tri_VER_Z)         /* tvc_z -= VER_Z */
+
+        /* "pv" section (ray x E_2) */
+        movpx_ld(Xmm4, Mebx, ctx_RAY_Y(0))      /* pvc_x <- RAY_Y */
+        mulps_ld(Xmm4, Medi, tri_E_2_Z)         /* pvc_x *= E_2_Z */
+        movpx_ld(Xmm0, Mebx, ctx_RAY_Z(0))      /* tmp_v <- RAY_Z */
+        mulps_ld(Xmm0, Medi, tri_E_2_Y)         /* tmp_v *= E_2_Y */
+        subps_rr(Xmm4, Xmm0)                    /* pvc_x -= tmp_v */
+        movpx_rr(Xmm5, Xmm4)                    /* d_val <- pvc_x */
+        mulps_ld(Xmm5, Medi, tri_E_1_X)         /* d_val *= E_1_X */
+        mulps_rr(Xmm4, Xmm1)                    /* pvc_x *= tvc_x */
+        movpx_rr(Xmm6, Xmm4)                    /* u_val <- pvc_x */
+
+        movpx_ld(Xmm4, Mebx, ctx_RAY_Z(0))      /* pvc_y <- RAY_Z */
+        mulps_ld(Xmm4, Medi, tri_E_2_X)         /* pvc_y *= E_2_X */
+        movpx_ld(Xmm0, Mebx, ctx_RAY_X(0))      /* tmp_v <- RAY_X */
+        mulps_ld(Xmm0, Medi, tri_E_2_Z)         /* tmp_v *= E_2_Z */
+        subps_rr(Xmm4, Xmm0)                    /* pvc_y -= tmp_v */
+        movpx_rr(Xmm0, Xmm4)                    /* tmp_v <- pvc_y */
+        mulps_ld(Xmm0, Medi, tri_E_1_Y)         /* tmp_v *= E_1_Y */
+        addps_rr(Xmm5, Xmm0)                    /* d_val += tmp_v */
+        mulps_rr(Xmm4, Xmm2)                    /* pvc_y *= tvc_y */
+        addps_rr(Xmm6, Xmm4)                    /* u_val += pvc_y */
+
+        movpx_ld(Xmm4, Mebx, ctx_RAY_X(0))      /* pvc_z <- RAY_X */
+        mulps_ld(Xmm4, Medi, tri_E_2_Y)         /* pvc_z *= E_2_Y */
+        movpx_ld(Xmm0, Mebx, ctx_RAY_Y(0))      /* tmp_v <- RAY_Y */
+        mulps_ld(Xmm0, Medi, tri_E_2_X)         /* tmp_v *= E_2_X */
+        subps_rr(Xmm4, Xmm0)                    /* pvc_z -= tmp_v */
+        movpx_rr(Xmm0, Xmm4)                    /* tmp_v <- pvc_z */
+        mulps_ld(Xmm0, Medi, tri_E_1_Z)         /* tmp_v *= E_1_Z */
+        addps_rr(Xmm5, Xmm0)                    /* d_val += tmp_v */
+        mulps_rr(Xmm4, Xmm3)                    /* pvc_z *= tvc_z */
+        addps_rr(Xmm6, Xmm4)                    /* u_val += pvc_z */
+
+        /* "d" section, keep determinant positive
+         * to avoid division in bounds checks,
+         * use context's normal fields (NRM)
+         * as temporary storage for triangle test */
+        movpx_ld(Xmm7, Mebp, inf_GPC06)         /* d_sgn <- -0.0f */
+        andpx_rr(Xmm7, Xmm5)                    /* d_sgn &= d_val */
+        xorpx_rr(Xmm5, Xmm7)                    /* d_val ^= d_sgn */
+        xorpx_rr(Xmm6, Xmm7)                    /* u_val ^= d_sgn */
+        movpx_st(Xmm6, Mecx, ctx_NRM_I)         /* u_val -> NRM_I */
+        movpx_st(Xmm7, Mecx, ctx_NRM_J)         /* d_sgn -> NRM_J */
+
+        /* "qv" section (tv x E_1) */
+        movpx_rr(Xmm4, Xmm2)                    /* qvc_x <- tvc_y */
+        mulps_ld(Xmm4, Medi, tri_E_1_Z)         /* qvc_x *= E_1_Z */
+        movpx_rr(Xmm0, Xmm3)                    /* tmp_v <- tvc_z */
+        mulps_ld(Xmm0, Medi, tri_E_1_Y)         /* tmp_v *= E_1_Y */
+        subps_rr(Xmm4, Xmm0)                    /* qvc_x -= tmp_v */
+        movpx_ld(Xmm6, Mebx, ctx_RAY_X(0))      /* v_val <- RAY_X */
+        mulps_rr(Xmm6, Xmm4)                    /* v_val *= qvc_x */
+        mulps_ld(Xmm4, Medi, tri_E_2_X)         /* qvc_x *= E_2_X */
+        movpx_rr(Xmm7, Xmm4)                    /* t_val <- qvc_x */
+
+        movpx_rr(Xmm4, Xmm3)                    /* qvc_y <- tvc_z */
+        mulps_ld(Xmm4, Medi, tri_E_1_X)         /* qvc_y *= E_1_X */
+        movpx_rr(Xmm0, Xmm1)                    /* tmp_v <- tvc_x */
+        mulps_ld(Xmm0, Medi, tri_E_1_Z)         /* tmp_v *= E_1_Z */
+        subps_rr(Xmm4, Xmm0)                    /* qvc_y -= tmp_v */
+        movpx_ld(Xmm0, Mebx, ctx_RAY_Y(0))      /* tmp_v <- RAY_Y */
+        mulps_rr(Xmm0, Xmm4)                    /* tmp_v *= qvc_y */
+        addps_rr(Xmm6, Xmm0)                    /* v_val += tmp_v */
+        mulps_ld(Xmm4, Medi, tri_E_2_Y)         /* qvc_y *= E_2_Y */
+        addps_rr(Xmm7, Xmm4)                    /* t_val += qvc_y */
+
+        mulps_ld(Xmm1, Medi, tri_E_1_Y)         /* qvc_z <- tvc_x */
+        mulps_ld(Xmm2, Medi, tri_E_1_X)         /* tvc_y *= E_1_X */
+        subps_rr(Xmm1, Xmm2)                    /* qvc_z -= tvc_y */
+        movpx_ld(Xmm0, Mebx, ctx_RAY_Z(0))      /* tmp_v <- RAY_Z */
+        mulps_rr(Xmm0, Xmm1)                    /* tmp_v *= qvc_z */
+        addps_rr(Xmm6, Xmm0)                    /* v_val += tmp_v */
+        mulps_ld(Xmm1, Medi, tri_E_2_Z)         /* qvc_z *= E_2_Z */
+        addps_rr(Xmm7, Xmm1)                    /* t_val += qvc_z */
+
+        xorpx_ld(Xmm6, Mecx, ctx_NRM_J)         /* v_val ^= d_sgn */
+        xorpx_ld(Xmm7, Mecx, ctx_NRM_J)         /* t_val ^= d_sgn */
+
+        /* create tmask */
+        xorpx_rr(Xmm0, Xmm0)                    /* tmask <-     0 */
+        cleps_rr(Xmm0, Xmm6)                    /* tmask <= v_val */
+        addps_ld(Xmm6, Mecx, ctx_NRM_I)         /* v_val += u_val */
+        cleps_rr(Xmm6, Xmm5)                    /* v_val <= d_val */
+        andpx_rr(Xmm0, Xmm6)                    /* tmask &= vmask */
+        xorpx_rr(Xmm1, Xmm1)                    /* umask <-     0 */
+        cleps_ld(Xmm1, Mecx, ctx_NRM_I)         /* umask <= u_val */
+        andpx_rr(Xmm0, Xmm1)                    /* tmask &= umask */
+        movpx_ld(Xmm2, Mecx, ctx_XTMP1)         /* t_min <- XTMP1 */
+        mulps_rr(Xmm2, Xmm5)                    /* t_min *= d_val */
+        cltps_rr(Xmm2, Xmm7)                    /* t_min <! t_val */
+        andpx_rr(Xmm0, Xmm2)                    /* tmask &= lmask */
+        movpx_ld(Xmm3, Mecx, ctx_T_VAL(0))      /* t_max <- T_VAL */
+        mulps_rr(Xmm3, Xmm5)                    /* t_max *= d_val */
+        cgtps_rr(Xmm3, Xmm7)                    /* t_max >! t_val */
+        andpx_rr(Xmm0, Xmm3)                    /* tmask &= gmask */
+        andpx_ld(Xmm0, Mecx, ctx_WMASK)         /* tmask &= WMASK */
+        CHECK_MASK(360198f, NONE, Xmm0)         /* MG_skp */
+
+        /* store nearest hit */
+        divps_rr(Xmm7, Xmm5)                    /* t_val /= d_val */
+        movpx_rr(Xmm6, Xmm0)                    /* tmask <- tmask */
+        mmvpx_st(Xmm7, Mecx, ctx_T_VAL(0))      /* t_val -> T_VAL */
+
+        movpx_rr(Xmm0, Xmm6)                    /* tmask <- tmask */
+        movpx_ld(Xmm1, Medi, tri_NRM_X)         /* nrm_x <- NRM_X */
+        mmvpx_st(Xmm1, Mesi, ctx_NEW_X(0))      /* nrm_x -> NEW_X */
+        movpx_rr(Xmm0, Xmm6)                    /* tmask <- tmask */
+        movpx_ld(Xmm2, Medi, tri_NRM_Y)         /* nrm_y <- NRM_Y */
+        mmvpx_st(Xmm2, Mesi, ctx_NEW_Y(0))      /* nrm_y -> NEW_Y */
+        movpx_rr(Xmm0, Xmm6)                    /* tmask <- tmask */
+        movpx_ld(Xmm3, Medi, tri_NRM_Z)         /* nrm_z <- NRM_Z */
+        mmvpx_st(Xmm3, Mesi, ctx_NEW_Z(0))      /* nrm_z -> NEW_Z */
+
+    LBL(360198) /* MG_skp */
+
+        addxx_ri(Redi, IH(Q*0x0C0))
+        cmjxx_rm(Redi, Medx, msh_TRI_P(FLG),
+                 NE_x, 360177b) /* MG_tri */
+
+    LBL(360638) /* MG_nxt */
+
+        movxx_ld(Redx, Medx, msh_NXT_P(PTR))
+        jmpxx_lb(360639f) /* MG_chk */
+
+    LBL(360635) /* MG_mis */
+
+        movxx_ld(Redx, Medx, msh_NXT_P(FLG))
+
+    LBL(360639) /* MG_chk */
+
+        cmjxx_rz(Redx,
+                 NE_x, 360676b) /* MG_cyc */
+
+/******************************************************************************/
+
+        stack_ld(Resi)
+        movxx_ld(Rebx, Mesi, elm_SIMD)
+
+        /* create xmask */
+        movpx_ld(Xmm7, Mecx, ctx_T_BUF(0))      /* xmask <- T_BUF */
+        cgtps_ld(Xmm7, Mecx, ctx_T_VAL(0))      /* xmask >! T_VAL */
+        andpx_ld(Xmm7, Mecx, ctx_WMASK)         /* xmask &= WMASK */
+        CHECK_MASK(990598f, NONE, Xmm7)         /* OO_end */
+
+        /* clipping */
+        SUBROUTINE(12, 660622b) /* CC_clp */
+        CHECK_MASK(990598f, NONE, Xmm7)         /* OO_end */
+        movpx_st(Xmm7, Mecx, ctx_XMASK)         /* xmask -> XMASK */
+
+        /* move hit's normal to the axis set
+         * of local HIT (stored with hits in buffers),
+         * local HIT is restored from HIT in MG_mat */
+        movwx_ld(Reax, Mebx, srf_A_SGN(RT_L*4)) /* Reax is used in Iecx */
+        xorxx_ri(Reax, IH(Q*0x30))
+        movpx_ld(Xmm4, Iecx, ctx_NEW_X(0))      /* nrm_x <- NEW_X */
+        movpx_ld(Xmm5, Iecx, ctx_NEW_Y(0))      /* nrm_y <- NEW_Y */
+        movpx_ld(Xmm6, Iecx, ctx_NEW_Z(0))      /* nrm_z <- NEW_Z */
+        xorxx_ri(Reax, IH(Q*0x30))
+        movpx_st(Xmm4, Iecx, ctx_NEW_X(0))      /* nrm_x -> NEW_X */
+        movpx_st(Xmm5, Iecx, ctx_NEW_Y(0))      /* nrm_y -> NEW_Y */
+        movpx_st(Xmm6, Iecx, ctx_NEW_Z(0))      /* nrm_z -> NEW_Z */
+
+        /* "dn" section (ray . normal) */
+        movpx_ld(Xmm1, Iecx, ctx_RAY_X(0))      /* ray_x <- RAY_X */
+        mulps_rr(Xmm1, Xmm4)                    /* ray_x *= nrm_x */
+        movpx_ld(Xmm2, Iecx, ctx_RAY_Y(0))      /* ray_y <- RAY_Y */
+        mulps_rr(Xmm2, Xmm5)                    /* ray_y *= nrm_y */
+        movpx_ld(Xmm3, Iecx, ctx_RAY_Z(0))      /* ray_z <- RAY_Z */
+        mulps_rr(Xmm3, Xmm6)                    /* ray_z *= nrm_z */
+        addps_rr(Xmm1, Xmm2)                    /* d_val += ray_y */
+        addps_rr(Xmm1, Xmm3)                    /* d_val += ray_z */
+        xorpx_rr(Xmm0, Xmm0)                    /* tmp_v <-     0 */
+
+/******************************************************************************/
+/*  LBL(MG_rt1)  */
+
+        /* outer side */
+        cltps_rr(Xmm1, Xmm0)                    /* d_val <! tmp_v */
+        andpx_rr(Xmm7, Xmm1)                    /* tmask &= lmask */
+        movpx_st(Xmm7, Mecx, ctx_TMASK(0))      /* tmask -> TMASK */
+        CHECK_MASK(360132f, NONE, Xmm7)         /* MG_rt2 */
+        movxx_mi(Mecx, ctx_LOCAL(FLG), IB(RT_FLAG_SIDE_OUTER))
+
+#if RT_FEAT_BUFFERS
+
+        CHECK_FLAG(360841f, PARAM, RT_FLAG_SHAD) /* MG_bf1 */
+
+        jmpxx_lb(360331f) /* MG_mt1 */
+
+    LBL(360841) /* MG_bf1 */
+
+        movxx_ri(Redx, IB(RT_FLAG_SIDE_OUTER))
+        STORE_SPTR(MG_rt1) /* destroys Xmm0/1/2, Reax; reads Rebx, Redx, Resi */
+
+        jmpxx_lb(360132f)
+
+    LBL(360331) /* MG_mt1 */
+
+#endif /* RT_FEAT_BUFFERS */
+
+        /* material */
+        SUBROUTINE(13, 360353f) /* MG_mat */
+
+/******************************************************************************/
+    LBL(360132) /* MG_rt2 */
+
+        /* inner side */
+        movpx_ld(Xmm7, Mecx, ctx_TMASK(0))      /* tmask <- TMASK */
+        xorpx_ld(Xmm7, Mecx, ctx_XMASK)         /* tmask ^= XMASK */
+        CHECK_MASK(990598f, NONE, Xmm7)         /* OO_end */
+        movpx_st(Xmm7, Mecx, ctx_TMASK(0))      /* tmask -> TMASK */
+        movxx_mi(Mecx, ctx_LOCAL(FLG), IB(RT_FLAG_SIDE_INNER))
+
+#if RT_FEAT_BUFFERS
+
+        CHECK_FLAG(360842f, PARAM, RT_FLAG_SHAD) /* MG_bf2 */
+
+        jmpxx_lb(360332f) /* MG_mt2 */
+
+    LBL(360842) /* MG_bf2 */
+
+        movxx_ri(Redx, IB(RT_FLAG_SIDE_INNER))
+        STORE_SPTR(MG_rt2) /* destroys Xmm0/1/2, Reax; reads Rebx, Redx, Resi */
+
+        jmpxx_lb(990598f) /* OO_end */
+
+    LBL(360332) /* MG_mt2 */
+
+#endif /* RT_FEAT_BUFFERS */
+
+        /* material */
+        SUBROUTINE(14, 360353f) /* MG_mat */
+
+        jmpxx_lb(990598f) /* OO_end */
+
+/******************************************************************************/
+    LBL(360353) /* MG_mat */
+
+        FETCH_PROP()                            /* Xmm7  <- tside */
+
+#if RT_FEAT_LIGHTS_SHADOWS
+
+        CHECK_SHAD(MG_shd)
+
+#endif /* RT_FEAT_LIGHTS_SHADOWS */
+
+#if RT_FEAT_NORMALS
+
+        /* compute normal, if enabled */
+        CHECK_PROP(360913f, RT_PROP_NORMAL)     /* MG_nrm */
+
+        movwx_ld(Reax, Mebx, srf_A_SGN(RT_L*4)) /* Reax is used in Iecx */
+
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for hit's normal */
+        movpx_ld(Xmm4, Iecx, ctx_NEW_X(0))      /* nrm_x <- NEW_X */
+        movpx_ld(Xmm5, Iecx, ctx_NEW_Y(0))      /* nrm_y <- NEW_Y */
+        movpx_ld(Xmm6, Iecx, ctx_NEW_Z(0))      /* nrm_z <- NEW_Z */
+
+        xorpx_rr(Xmm4, Xmm7)                    /* nrm_x ^= tside */
+        xorpx_rr(Xmm5, Xmm7)                    /* nrm_y ^= tside */
+        xorpx_rr(Xmm6, Xmm7)                    /* nrm_z ^= tside */
+
+        /* store normal */
+        movpx_st(Xmm4, Iecx, ctx_NRM_X)         /* nrm_x -> NRM_X */
+        movpx_st(Xmm5, Iecx, ctx_NRM_Y)         /* nrm_y -> NRM_Y */
+        movpx_st(Xmm6, Iecx, ctx_NRM_Z)         /* nrm_z -> NRM_Z */
+
+    LBL(360913) /* MG_nrm */
+
+#endif /* RT_FEAT_NORMALS */
+
+#if RT_FEAT_TEXTURING
+
+        /* pick surface's UV plane
+         * by the dominant axis of normal
+         * for texturing, if enabled */
+        CHECK_PROP(360357f, RT_PROP_TEXTURE)    /* MG_pln */
+
+        INDEX_AXIS(RT_I)                        /* Reax  <-     i */
+        movpx_ld(Xmm4, Iecx, ctx_NEW_O)         /* nrm_i <- NEW_I */
+        andpx_ld(Xmm4, Mebp, inf_GPC04)         /* nrm_i = |nrm_i| */
+        INDEX_AXIS(RT_J)                        /* Reax  <-     j */
+        movpx_ld(Xmm5, Iecx, ctx_NEW_O)         /* nrm_j <- NEW_J */
+        andpx_ld(Xmm5, Mebp, inf_GPC04)         /* nrm_j = |nrm_j| */
+        INDEX_AXIS(RT_K)                        /* Reax  <-     k */
+        movpx_ld(Xmm6, Iecx, ctx_NEW_O)         /* nrm_k <- NEW_K */
+        andpx_ld(Xmm6, Mebp, inf_GPC04)         /* nrm_k = |nrm_k| */
+
+        /* use context's texture fields (TEX)
+         * as temporary storage for UV plane */
+        movpx_rr(Xmm1, Xmm6)                    /* kmask <- nrm_k */
+        cgeps_rr(Xmm1, Xmm4)                    /* kmask >= nrm_i */
+        movpx_rr(Xmm2, Xmm6)                    /* tmp_v <- nrm_k */
+        cgeps_rr(Xmm2, Xmm5)                    /* tmp_v >= nrm_j */
+        andpx_rr(Xmm1, Xmm2)                    /* kmask &= tmp_v */
+        movpx_st(Xmm1, Mecx, ctx_TEX_U)         /* kmask -> TEX_U */
+        cgeps_rr(Xmm4, Xmm5)                    /* nrm_i >= nrm_j */
+        annpx_rr(Xmm1, Xmm4)                    /* imask = ~kmask */
+        movpx_st(Xmm1, Mecx, ctx_TEX_V)         /* imask -> TEX_V */
+
+    LBL(360357) /* MG_pln */
+
+#endif /* RT_FEAT_TEXTURING */
+
+        /* restore local HIT in place of normal */
+        movpx_ld(Xmm1, Mecx, ctx_HIT_X(0))      /* hit_x <- HIT_X */
+        movpx_ld(Xmm2, Mecx, ctx_HIT_Y(0))      /* hit_y <- HIT_Y */
+        movpx_ld(Xmm3, Mecx, ctx_HIT_Z(0))      /* hit_z <- HIT_Z */
+
+#if RT_FEAT_TRANSFORM
+
+        cmjwx_mz(Mebx, srf_A_MAP(RT_L*4),
+                 EQ_x, 360296f) /* MG_loc */
+
+        movxx_ld(Redx, Mebx, srf_MSC_P(OBJ))    /* load trnode's simd ptr */
+
+        subps_ld(Xmm1, Medx, srf_POS_X)         /* hit_x -= POS_X */
+        subps_ld(Xmm2, Medx, srf_POS_Y)         /* hit_y -= POS_Y */
+        subps_ld(Xmm3, Medx, srf_POS_Z)         /* hit_z -= POS_Z */
+
+        /* transform hit,
+         * apply full matrix */
+        movpx_ld(Xmm4, Medx, srf_TCI_X)
+        mulps_rr(Xmm4, Xmm1)
+        movpx_ld(Xmm0, Medx, srf_TCI_Y)
+        mulps_rr(Xmm0, Xmm2)
+        addps_rr(Xmm4, Xmm0)
+        movpx_ld(Xmm0, Medx, srf_TCI_Z)
+        mulps_rr(Xmm0, Xmm3)
+        addps_rr(Xmm4, Xmm0)
+
+        movpx_ld(Xmm5, Medx, srf_TCJ_X)
+        mulps_rr(Xmm5, Xmm1)
+        movpx_ld(Xmm0, Medx, srf_TCJ_Y)
+        mulps_rr(Xmm0, Xmm2)
+        addps_rr(Xmm5, Xmm0)
+        movpx_ld(Xmm0, Medx, srf_TCJ_Z)
+        mulps_rr(Xmm0, Xmm3)
+        addps_rr(Xmm5, Xmm0)
+
+        movpx_ld(Xmm6, Medx, srf_TCK_X)
+        mulps_rr(Xmm6, Xmm1)
+        movpx_ld(Xmm0, Medx, srf_TCK_Y)
+        mulps_rr(Xmm0, Xmm2)
+        addps_rr(Xmm6, Xmm0)
+        movpx_ld(Xmm0, Medx, srf_TCK_Z)
+        mulps_rr(Xmm0, Xmm3)
+        addps_rr(Xmm6, Xmm0)
+
+        /* surface's own POS is relative
+         * to its trnode, if not trnode itself */
+        cmjxx_rr(Redx, Rebx,
+                 EQ_x, 360628f) /* MG_glb */
+
+        subps_ld(Xmm4, Mebx, srf_POS_X)         /* loc_i -= POS_X */
+        subps_ld(Xmm5, Mebx, srf_POS_Y)         /* loc_j -= POS_Y */
+        subps_ld(Xmm6, Mebx, srf_POS_Z)         /* loc_k -= POS_Z */
+
+    LBL(360628) /* MG_glb */
+
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for local HIT */
+        movpx_st(Xmm4, Mecx, ctx_NEW_I(0))      /* loc_i -> NEW_I */
+        movpx_st(Xmm5, Mecx, ctx_NEW_J(0))      /* loc_j -> NEW_J */
+        movpx_st(Xmm6, Mecx, ctx_NEW_K(0))      /* loc_k -> NEW_K */
+
+        jmpxx_lb(360195f) /* MG_hit */
+
+    LBL(360296) /* MG_loc */
+
+#endif /* RT_FEAT_TRANSFORM */
+
+        subps_ld(Xmm1, Mebx, srf_POS_X)         /* loc_x -= POS_X */
+        subps_ld(Xmm2, Mebx, srf_POS_Y)         /* loc_y -= POS_Y */
+        subps_ld(Xmm3, Mebx, srf_POS_Z)         /* loc_z -= POS_Z */
+
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for local HIT */
+        movpx_st(Xmm1, Mecx, ctx_NEW_X(0))      /* loc_x -> NEW_X */
+        movpx_st(Xmm2, Mecx, ctx_NEW_Y(0))      /* loc_y -> NEW_Y */
+        movpx_st(Xmm3, Mecx, ctx_NEW_Z(0))      /* loc_z -> NEW_Z */
+
+    LBL(360195) /* MG_hit */
+
+#if RT_FEAT_TEXTURING
+
+        /* compute surface's UV coords
+         * for texturing, if enabled */
+        CHECK_PROP(360358f, RT_PROP_TEXTURE)    /* MG_tex */
+
+        INDEX_AXIS(RT_I)                        /* Reax  <-     i */
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for local HIT */
+        MOVXR_LD(Xmm4, Iecx, ctx_NEW_O)         /* loc_i <- NEW_I */
+
+        INDEX_AXIS(RT_J)                        /* Reax  <-     j */
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for local HIT */
+        MOVXR_LD(Xmm5, Iecx, ctx_NEW_O)         /* loc_j <- NEW_J */
+
+        INDEX_AXIS(RT_K)                        /* Reax  <-     k */
+        /* use next context's RAY fields (NEW)
+         * as temporary storage for local HIT */
+        MOVXR_LD(Xmm6, Iecx, ctx_NEW_O)         /* loc_k <- NEW_K */
+
+        /* (i, j) for k-plane, (j, k) for i-plane,
+         * (i, k) for j-plane */
+        movpx_rr(Xmm1, Xmm5)                    /* loc_j <- loc_j */
+        movpx_ld(Xmm0, Mecx, ctx_TEX_V)         /* imask <- TEX_V */
+        mmvpx_rr(Xmm4, Xmm1)                    /* loc_i mm loc_j */
+        movpx_ld(Xmm0, Mecx, ctx_TEX_U)         /* kmask <- TEX_U */
+        mmvpx_rr(Xmm6, Xmm5)                    /* loc_k mm loc_j */
+        movpx_st(Xmm4, Mecx, ctx_TEX_U)         /* tex_u -> TEX_U */
+        movpx_st(Xmm6, Mecx, ctx_TEX_V)         /* tex_v -> TEX_V */
+
+    LBL(360358) /* MG_tex */
+
+#endif /* RT_FEAT_TEXTURING */
+
+#if RT_FEAT_NORMALS
+
+        CHECK_PROP(330353b, RT_PROP_NORMAL)     /* MT_mat */
+
+        jmpxx_lb(330913b) /* MT_nrm */
+
+#endif /* RT_FEAT_NORMALS */
+
+        jmpxx_lb(330353b) /* MT_mat */
+
 /******************************************************************************/
 /*********************************   QUARTIC   ********************************/
 /******************************************************************************/
@@ -6985,10 +7704,14 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_BUFFERS == 0
 
-        /* accumulate path-tracer samples */
-        movxx_ld(Reax, Mebp, inf_FRM_Y)
-        mulxx_ld(Reax, Mebp, inf_FRM_ROW)
-        addxx_ld(Reax, Mebp, inf_FRM_X)
+        /* accumulate path-tracer samples,
+         * pixel blocks are laid out contiguously
+         * within their rows in fp-color planes */
+        movxx_ld(Reax, Mebp, inf_FRM_X)
+        mulxx_ld(Reax, Mebp, inf_BLK_H)
+        movxx_ld(Redx, Mebp, inf_FRM_Y)
+        mulxx_ld(Redx, Mebp, inf_FRM_ROW)
+        addxx_rr(Reax, Redx)
         shlxx_ri(Reax, IB(L+1))
         shlxx_rr(Reax, Rebx)
 
@@ -7169,10 +7892,70 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
         subxx_ri(Resi, IB(4*L))
         addxx_ri(Reax, IB(4))
 
+#if RT_FEAT_BUFFERS == 0
+
+        /* move to the next row of pixel block */
+        movxx_ld(Redx, Mebp, inf_BLK_W)
+        shlxx_ri(Redx, IB(2))
+        subxx_ri(Redx, IB(1))
+        andxx_rr(Redx, Reax)
+        cmjxx_rz(Redx,
+                 NE_x, 440134f) /* FF_cnt */
+
+        movxx_ld(Redx, Mebp, inf_FRM_ROW)
+        subxx_ld(Redx, Mebp, inf_BLK_W)
+        shlxx_ri(Redx, IB(2))
+        addxx_rr(Rebx, Redx)
+
+    LBL(440134) /* FF_cnt */
+
+#endif /* RT_FEAT_BUFFERS == 0 */
+
         cmjxx_rz(Resi,
                  NE_x, 440676b) /* FF_cyc */
 
-        shrxx_ri(Reax, IB(2))
+#if RT_PROFILE
+
+        /* store packet's cost to the heatmap plane
+         * at the block's origin: elements visited (bits 0-11),
+         * root-solver calls (bits 12-23), depth reached (bits 24-31) */
+        movxx_ld(Rebx, Mebp, inf_HMAP)
+        cmjxx_rz(Rebx,
+                 EQ_x, 440923f) /* FF_hmp */
+
+        movxx_ld(Reax, Mebp, inf_FRM_X)
+        shlxx_ri(Reax, IB(2))
+        addxx_ld(Reax, Mebp, inf_FRM)
+        subxx_ld(Reax, Mebp, inf_FRAME)
+        addxx_rr(Rebx, Reax)
+
+        movxx_ld(Reax, Mebp, inf_HMP_E)
+        cmjxx_ri(Reax, IH(0xFFF),
+                 LE_x, 440131f) /* FF_hme */
+        movxx_ri(Reax, IH(0xFFF))
+
+    LBL(440131) /* FF_hme */
+
+        movxx_ld(Redx, Mebp, inf_HMP_S)
+        cmjxx_ri(Redx, IH(0xFFF),
+                 LE_x, 440132f) /* FF_hms */
+        movxx_ri(Redx, IH(0xFFF))
+
+    LBL(440132) /* FF_hms */
+
+        shlxx_ri(Redx, IB(12))
+        orrxx_rr(Reax, Redx)
+        movxx_ld(Redx, Mebp, inf_DEPTH)
+        subxx_ld(Redx, Mebp, inf_HMP_D)
+        shlxx_ri(Redx, IB(24))
+        orrxx_rr(Reax, Redx)
+        movwx_st(Reax, Mebx, DP(0))
+
+    LBL(440923) /* FF_hmp */
+
+#endif /* RT_PROFILE */
+
+        movxx_ld(Reax, Mebp, inf_BLK_W)
         addxx_st(Reax, Mebp, inf_FRM_X)
 
         movxx_ld(Reax, Mebp, inf_FRM_X)
@@ -7223,12 +8006,14 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNUM)
+        movxx_ld(Reax, Mebp, inf_FRM_U)
+        mulxx_ld(Reax, Mebp, inf_BLK_H)
         addxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
 
-        addxx_mi(Mebp, inf_FRM_Y, IB(1))
+        movxx_ld(Reax, Mebp, inf_BLK_H)
+        addxx_st(Reax, Mebp, inf_FRM_Y)
 
 #endif /* RT_FEAT_MULTITHREADING */
 
@@ -7380,7 +8165,7 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNDX)
+        movxx_ld(Reax, Mebp, inf_FRM_I)
         movxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -7597,7 +8382,19 @@ rt_void render0(rt_SIMD_INFOX *s_inf)
 
 #if RT_FEAT_MULTITHREADING
 
-        movxx_ld(Reax, Mebp, inf_THNUM)
+        /* rows of pixel blocks are interleaved */
+        addxx_mi(Mebp, inf_FRM_Y, IB(1))
+
+        movxx_ld(Reax, Mebp, inf_FRM_Y)
+        prexx_xx()
+        divxx_xm(Mebp, inf_BLK_H)
+        mulxx_ld(Reax, Mebp, inf_BLK_H)
+        cmjxx_rm(Reax, Mebp, inf_FRM_Y,
+                 NE_x, 370676b) /* TY_cyc */
+
+        movxx_ld(Reax, Mebp, inf_FRM_U)
+        subxx_ri(Reax, IB(1))
+        mulxx_ld(Reax, Mebp, inf_BLK_H)
         addxx_st(Reax, Mebp, inf_FRM_Y)
 
 #else /* RT_FEAT_MULTITHREADING */
@@ -8121,6 +8918,19 @@ rt_void rt_Platform::update0(rt_SIMD_SURFACE *s_srf)
         return;
     }
 
+    /* mesh has its own solver (with bvh traversal),
+     * its tags don't depend on the shape's coeffs */
+    if (tag == RT_TAG_MESH)
+    {
+        s_srf->srf_t[0] = 4;
+        s_srf->srf_t[1] = 4;
+        s_srf->srf_t[2] = 4;
+
+        s_srf->msc_p[1] = (rt_pntr)0;
+
+        return;
+    }
+
     /* set surface's tags */
     s_srf->srf_t[0] = tag > RT_TAG_PLANE ?
                      (tag == RT_TAG_HYPERCYLINDER &&
@@ -8187,7 +8997,7 @@ rt_si32 rt_Platform::switch0(rt_SIMD_INFOX *s_inf, rt_si32 simd)
 
 #if (RT_POINTER - RT_ADDRESS) != 0
 
-    if ((rt_full)s_inf >= (rt_full)(0x80000000 - sizeof(rt_SIMD_INFOX)))
+    if ((rt_full)s_inf >= RT_ADDRESS_TOP - sizeof(rt_SIMD_INFOX))
     {
         throw rt_Exception("address exceeded allowed range in switch0");
     }
@@ -50,6 +50,12 @@
 
 #define RT_STACK_DEPTH          10 /* context stack depth for secondary rays */
 
+#define RT_OCC_SLOTS            16 /* occluder cache slots, power of 2 */
+
+#ifndef RT_PROFILE
+#define RT_PROFILE              0  /* enables profiling counters and timers */
+#endif /* RT_PROFILE */
+
 #define LCG16                   16
 #define LCG24                   24
 #define LCG32                   32 /* applicable to 64-bit SIMD elements only */
@@ -104,6 +110,8 @@ struct rt_SIMD_CONTEXT;
 struct rt_SIMD_CAMERA;
 struct rt_SIMD_LIGHT;
 struct rt_SIMD_SURFACE;
+struct rt_SIMD_MESHNODE;
+struct rt_SIMD_MESHTRI;
 
 struct rt_SIMD_MATERIAL;
 
@@ -220,34 +228,97 @@ struct rt_SIMD_INFOX : public rt_SIMD_INFO
     rt_word pt_on;
 #define inf_PT_ON           DP(Q*0x100+0x04C*P+E)
 
+    rt_word frm_i;
+#define inf_FRM_I           DP(Q*0x100+0x050*P+E)
+
+    rt_word frm_u;
+#define inf_FRM_U           DP(Q*0x100+0x054*P+E)
+
+    /* pixel block covered by SIMD lanes,
+     * blk_h is 1 for scanline SIMD runs */
+
+    rt_word blk_w;
+#define inf_BLK_W           DP(Q*0x100+0x058*P+E)
+
+    rt_word blk_h;
+#define inf_BLK_H           DP(Q*0x100+0x05C*P+E)
+
     /* internal variables */
 
     rt_word frm_x;
-#define inf_FRM_X           DP(Q*0x100+0x050*P+E)
+#define inf_FRM_X           DP(Q*0x100+0x060*P+E)
 
     rt_word frm_y;
-#define inf_FRM_Y           DP(Q*0x100+0x054*P+E)
+#define inf_FRM_Y           DP(Q*0x100+0x064*P+E)
 
     rt_pntr frm;
-#define inf_FRM             DP(Q*0x100+0x058*P+E)
+#define inf_FRM             DP(Q*0x100+0x068*P+E)
 
     rt_word tls_x;
-#define inf_TLS_X           DP(Q*0x100+0x05C*P+E)
+#define inf_TLS_X           DP(Q*0x100+0x06C*P+E)
 
     rt_pntr tls;
-#define inf_TLS             DP(Q*0x100+0x060*P+E)
+#define inf_TLS             DP(Q*0x100+0x070*P+E)
 
     rt_pntr prngs;
-#define inf_PRNGS           DP(Q*0x100+0x064*P+E)
+#define inf_PRNGS           DP(Q*0x100+0x074*P+E)
 
     rt_pntr srf_e;
-#define inf_SRF_E           DP(Q*0x100+0x068*P+E)
+#define inf_SRF_E           DP(Q*0x100+0x078*P+E)
 
     rt_word srf_s;
-#define inf_SRF_S           DP(Q*0x100+0x06C*P+E)
+#define inf_SRF_S           DP(Q*0x100+0x07C*P+E)
+
+    /* profiling counters (RT_PROFILE),
+     * number of SIMD ray packets by kind */
+
+    rt_word cnt_prm;
+#define inf_CNT_PRM         DP(Q*0x100+0x080*P+E)
+
+    rt_word cnt_shd;
+#define inf_CNT_SHD         DP(Q*0x100+0x084*P+E)
+
+    rt_word cnt_rfl;
+#define inf_CNT_RFL         DP(Q*0x100+0x088*P+E)
+
+    rt_word cnt_rfr;
+#define inf_CNT_RFR         DP(Q*0x100+0x08C*P+E)
+
+    rt_word cnt_pth;
+#define inf_CNT_PTH         DP(Q*0x100+0x090*P+E)
+
+    /* number of SIMD bounding volume tests
+     * and root-solver invocations per surface tag */
+
+    rt_word cnt_bvt;
+#define inf_CNT_BVT         DP(Q*0x100+0x094*P+E)
+
+    rt_word cnt_srf[16];
+#define inf_CNT_SRF         DP(Q*0x100+0x098*P+E)
+
+    /* heatmap plane (RT_PROFILE), NULL if off,
+     * per-packet cost accumulated while tracing */
+
+    rt_pntr hmap;
+#define inf_HMAP            DP(Q*0x100+0x0D8*P+E)
+
+    rt_word hmp_e;
+#define inf_HMP_E           DP(Q*0x100+0x0DC*P+E)
+
+    rt_word hmp_s;
+#define inf_HMP_S           DP(Q*0x100+0x0E0*P+E)
 
-    rt_word pad11[36];
-#define inf_PAD11           DP(Q*0x100+0x070*P+E)
+    rt_word hmp_d;
+#define inf_HMP_D           DP(Q*0x100+0x0E4*P+E)
+
+    /* per-thread cache of last occluders (RT_OCC_SLOTS list elements
+     * hashed by shadow list, read-write), reset with lists rebuild */
+
+    rt_pntr occ;
+#define inf_OCC             DP(Q*0x100+0x0E8*P+E)
+
+    rt_word pad11[5];
+#define inf_PAD11           DP(Q*0x100+0x0EC*P+E)
 
     rt_uelm prngf[S];
 #define inf_PRNGF           DP(Q*0x100+0x100*P)
@@ -1180,6 +1251,108 @@ struct rt_SIMD_SURFACE
     rt_pntr lst_p[4];
 #define srf_LST_P(nx)       DP(Q*0x260+0x010+0x020*P+E + (nx)*P)
 
+    rt_pntr msh_p[4];
+#define srf_MSH_P(nx)       DP(Q*0x260+0x010+0x030*P+E + (nx)*P)
+
+};
+
+/******************************************************************************/
+/**********************************   MESH   **********************************/
+/******************************************************************************/
+
+/*
+ * SIMD mesh bvh node structure (in the same space as surface's local diff),
+ * nodes are stored depth-first, thus the skip pointer of a node
+ * leads to the node following its sub-tree (NULL for the last one).
+ * Structure is read-only in backend.
+ */
+struct rt_SIMD_MESHNODE
+{
+    /* node's bounding box */
+
+    rt_real min_x[S];
+#define msh_MIN_X           DP(Q*0x000)
+
+    rt_real min_y[S];
+#define msh_MIN_Y           DP(Q*0x010)
+
+    rt_real min_z[S];
+#define msh_MIN_Z           DP(Q*0x020)
+
+    rt_real max_x[S];
+#define msh_MAX_X           DP(Q*0x030)
+
+    rt_real max_y[S];
+#define msh_MAX_Y           DP(Q*0x040)
+
+    rt_real max_z[S];
+#define msh_MAX_Z           DP(Q*0x050)
+
+    /* next node if box is hit (PTR),
+     * next node if box is missed (FLG) */
+
+    rt_pntr nxt_p[R/P];
+#define msh_NXT_P(nx)       DP(Q*0x060+E + (nx)*P)
+
+    /* leaf's triangles from (PTR) to (FLG),
+     * both are NULL for inner nodes */
+
+    rt_pntr tri_p[R/P];
+#define msh_TRI_P(nx)       DP(Q*0x070+E + (nx)*P)
+
+};
+
+/*
+ * SIMD mesh triangle structure (in the same space as surface's local diff),
+ * outer normal is normalized and has orientation of local space winding.
+ * Structure is read-only in backend.
+ */
+struct rt_SIMD_MESHTRI
+{
+    /* first vertex */
+
+    rt_real ver_x[S];
+#define tri_VER_X           DP(Q*0x000)
+
+    rt_real ver_y[S];
+#define tri_VER_Y           DP(Q*0x010)
+
+    rt_real ver_z[S];
+#define tri_VER_Z           DP(Q*0x020)
+
+    /* edge to second vertex */
+
+    rt_real e_1_x[S];
+#define tri_E_1_X           DP(Q*0x030)
+
+    rt_real e_1_y[S];
+#define tri_E_1_Y           DP(Q*0x040)
+
+    rt_real e_1_z[S];
+#define tri_E_1_Z           DP(Q*0x050)
+
+    /* edge to third vertex */
+
+    rt_real e_2_x[S];
+#define tri_E_2_X           DP(Q*0x060)
+
+    rt_real e_2_y[S];
+#define tri_E_2_Y           DP(Q*0x070)
+
+    rt_real e_2_z[S];
+#define tri_E_2_Z           DP(Q*0x080)
+
+    /* outer normal */
+
+    rt_real nrm_x[S];
+#define tri_NRM_X           DP(Q*0x090)
+
+    rt_real nrm_y[S];
+#define tri_NRM_Y           DP(Q*0x0A0)
+
+    rt_real nrm_z[S];
+#define tri_NRM_Z           DP(Q*0x0B0)
+
 };
 
 /******************************************************************************/
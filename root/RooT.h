@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "engine.h"
+#include "rtscen.h"
 #include "all_scn.h"
 
 /* enable test scenes for smallpt-based path-tracer
@@ -44,6 +45,7 @@ rt_si32     x_res       = RT_X_RES;
 rt_si32     y_res       = RT_Y_RES;
 rt_si32     x_row       = (RT_X_RES+RT_SIMD_WIDTH-1) & ~(RT_SIMD_WIDTH-1);
 rt_ui32    *frame       = RT_NULL;
+rt_ui32    *f_next      = RT_NULL; /* next framebuffer from frame_to_screen */
 rt_si32     thnum       = RT_THREADS_NUM;
 
 rt_SCENE   *sc_rt[]     =
@@ -61,6 +63,8 @@ rt_Platform*pfm                     = RT_NULL;              /* platformobj */
 rt_Scene   *sc[RT_ARR_SIZE(sc_rt)]  = {0};                  /* scene array */
 rt_si32     d                       = RT_ARR_SIZE(sc_rt)-1; /* demo-scene */
 rt_si32     c                       = 0;                    /* camera-idx */
+rt_Heap    *hp_load                 = RT_NULL;              /* scene-heap */
+rt_SCENE   *sc_load                 = RT_NULL;              /* scene-file */
 rt_si32     tile_w                  = 0;                    /* tile width */
 
 rt_time     b_time      = 0;        /* time-begins-(ms) (from command-line) */
@@ -72,6 +76,8 @@ rt_si32     n_simd      = 0;        /* SIMD native size (from command-line) */
 rt_si32     k_size      = 0;        /* SIMD size-factor (from command-line) */
 rt_si32     s_type      = 0;        /* SIMD sub-variant (from command-line) */
 rt_si32     t_pool      = 0;        /* Thread-pool size (from command-line) */
+rt_si32     t_mode      = 0;        /* Thread-placement (from command-line) */
+rt_si32     v_mode      = 0;        /* Huge-page chunks (from command-line) */
 #if RT_FULLSCREEN == 1
 rt_si32     w_size      = 0;        /* Window-rect size (from command-line) */
 #else  /* RT_FULLSCREEN */
@@ -81,6 +87,7 @@ rt_si32     x_new       = 0;        /* New x-resolution (from command-line) */
 rt_si32     y_new       = 0;        /* New y-resolution (from command-line) */
 
 rt_si32     img_id      =-1;        /* save-image-index (from command-line) */
+rt_pstr     j_name      = RT_NULL;  /* scene-file-name (from command-line) */
 rt_time     l_time      = 500;        /* fpslogupd-(ms) (from command-line) */
 rt_bool     l_mode      = RT_FALSE;        /* fpslogoff (from command-line) */
 rt_bool     h_mode      = RT_FALSE;        /* hide mode (from command-line) */
@@ -116,11 +123,23 @@ rt_pntr sys_alloc(rt_size size);
  */
 rt_void sys_free(rt_pntr ptr, rt_size size);
 
+/*
+ * Set huge-page mode for allocations of whole huge pages,
+ * return the mode applied (0 if not supported).
+ */
+rt_si32 sys_huge(rt_si32 mode);
+
 /*
  * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
  */
 rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm);
 
+/*
+ * Return the number of threads placed by "mode" (1 - per cpu, 2 - per core,
+ * 3 - per L3-domain) on available CPUs, 0 if placement is not supported.
+ */
+rt_si32 topo_threads(rt_si32 mode);
+
 /*
  * Terminate platform-specific pool of "thnum" threads.
  */
@@ -139,9 +158,10 @@ rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
 rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase);
 
 /*
- * Set current frame to screen.
+ * Set current frame to screen, return framebuffer for the next frame
+ * if platform rotates them (asynchronous present), NULL otherwise.
  */
-rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row);
+rt_ui32* frame_to_screen(rt_ui32 *frame, rt_si32 x_row);
 
 /******************************************************************************/
 /*******************************   EVENT-LOOP   *******************************/
@@ -322,6 +342,12 @@ rt_si32 main_step()
             l_mode = !l_mode;
             switched = 1;
         }
+        if (T_KEYS(RK_F9))
+        {
+            /* cycle heatmap modes exported by save_frame,
+             * stays 0 unless RT_PROFILE is enabled in the build */
+            sc[d]->set_hmap((sc[d]->get_hmap() + 1) % 4);
+        }
         if (T_KEYS(RK_P))
         {
             p_prev = p_mode;
@@ -723,6 +749,12 @@ rt_si32 main_step()
         cnt++;
         ttl++;
 
+        /* render to the framebuffer not held by present */
+        if (f_next != RT_NULL)
+        {
+            sc[d]->set_frame(f_next, x_row);
+        }
+
         sc[d]->render(f_time >= 0 ? b_time + f_time * ttl : anim_time);
 
         if (!h_mode)
@@ -758,7 +790,7 @@ rt_si32 main_step()
 
     if (!o_mode)
     {
-        frame_to_screen(sc[d]->get_frame(), sc[d]->get_x_row());
+        f_next = frame_to_screen(sc[d]->get_frame(), sc[d]->get_x_row());
     }
 
     return 1;
@@ -776,6 +808,7 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
         RT_LOGI("--------------------------------------------------------\n");
         RT_LOGI("Usage options are given below:\n");
         RT_LOGI(" -d n, specify default demo-scene, where 1 <= n <= d_num\n");
+        RT_LOGI(" -j f, replace default demo-scene with binary scene-file\n");
         RT_LOGI(" -c n, specify default camera-idx, where 1 <= n <= c_num\n");
         RT_LOGI(" -b n, specify time (ms) at which testing begins, n >= 0\n");
         RT_LOGI(" -e n, specify time (ms) at which testing ends, n >= min\n");
@@ -798,6 +831,8 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -q, quake mode, enables path-tracing for quality lights\n");
         RT_LOGI(" -t, trace mode, toggles path-tracing for quality lights\n");
         RT_LOGI(" -u n, 1-3/4 serial update/render, 5/6 update/render off\n");
+        RT_LOGI(" -z n, threads per 1 cpu, 2 core, 3 L3-domain, 0 - auto\n");
+        RT_LOGI(" -v n, heap huge pages, 1 transparent, 2 explicit, 0 off\n");
         RT_LOGI(" -o, offscreen-frame mode, turns off window-rect updates\n");
         RT_LOGI(" -a, enable 4x antialiasing by default, 8x not supported\n");
         RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
@@ -824,6 +859,11 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
                 return 0;
             }
         }
+        if (k < argc && strcmp(argv[k], "-j") == 0 && ++k < argc)
+        {
+            RT_LOGI("Scene-file overridden: %s\n", argv[k]);
+            j_name = argv[k];
+        }
         if (k < argc && strcmp(argv[k], "-c") == 0 && ++k < argc)
         {
             for (l = strlen(argv[k]), r = 1, t = 0; l > 0; l--, r *= 10)
@@ -1150,6 +1190,34 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
                 return 0;
             }
         }
+        if (k < argc && strcmp(argv[k], "-z") == 0 && ++k < argc)
+        {
+            t = argv[k][0] - '0';
+            if (strlen(argv[k]) == 1 && t >= 0 && t <= 3)
+            {
+                RT_LOGI("Thread-placement overridden: %d\n", t);
+                t_mode = t;
+            }
+            else
+            {
+                RT_LOGI("Thread-placement value out of range\n");
+                return 0;
+            }
+        }
+        if (k < argc && strcmp(argv[k], "-v") == 0 && ++k < argc)
+        {
+            t = argv[k][0] - '0';
+            if (strlen(argv[k]) == 1 && t >= 0 && t <= 2)
+            {
+                RT_LOGI("Heap huge-pages overridden: %d\n", t);
+                v_mode = t;
+            }
+            else
+            {
+                RT_LOGI("Heap huge-pages value out of range\n");
+                return 0;
+            }
+        }
         if (k < argc && strcmp(argv[k], "-o") == 0 && !o_mode)
         {
             o_mode = RT_TRUE;
@@ -1189,6 +1257,118 @@ rt_si32 args_init(rt_si32 argc, rt_char *argv[])
     return 1;
 }
 
+#define RT_CALIB_FRAMES     16 /* frames to render per placement policy */
+
+/*
+ * Pick thread-placement policy (t_mode) with a short render of the default
+ * scene for each: 1 - thread per cpu (SMT thread), 2 - per physical core,
+ * 3 - per L3 domain. Policies resulting in the same number of threads
+ * as the one measured before are skipped (for instance, without SMT),
+ * nothing is rendered if placement is not supported or all policies
+ * result in the same number of threads (no topology), 1 is returned.
+ */
+rt_si32 main_calib()
+{
+    rt_si32 i, j, m, best = 1, num[4] = {0};
+    rt_time t, tmin = -1;
+
+    try
+    {
+        for (m = 1; m <= 3; m++)
+        {
+            num[m] = topo_threads(m);
+        }
+    }
+    catch (rt_Exception e)
+    {
+        RT_LOGE("Exception in main_calib: %s\n", e.err);
+        return best;
+    }
+
+    /* nothing to choose from if placement is not supported (Windows, macOS)
+     * or if topology isn't present, default policy is used without render */
+    if (num[1] == 0 || (num[2] == num[1] && num[3] == num[1]))
+    {
+        return best;
+    }
+
+    for (m = 1; m <= 3; m++)
+    {
+        rt_Platform *pcal = RT_NULL;
+        rt_Scene    *scal = RT_NULL;
+
+        /* skip policy placing as many threads as the one measured before */
+        for (j = 1; j < m; j++)
+        {
+            if (num[j] == num[m])
+            {
+                break;
+            }
+        }
+
+        if (j < m)
+        {
+            continue;
+        }
+
+        t_mode = m;
+
+        try
+        {
+            pcal = new rt_Platform(sys_alloc, sys_free, thnum,
+                                   init_threads, term_threads,
+                                   update_scene, render_scene);
+
+            pcal->set_simd(simd_init(n_simd, s_type, k_size));
+            pcal->set_fsaa(a_mode);
+
+            scal = new(pcal) rt_Scene(sc_rt[d],
+                                      x_res, y_res, x_row, frame, pcal);
+
+            /* first frames build lists and warm up caches */
+            for (i = -2, t = 0; i < RT_CALIB_FRAMES; i++)
+            {
+                t = i == 0 ? get_time() : t;
+                scal->render(b_time + i * 20);
+            }
+            t = get_time() - t;
+
+            RT_LOGI("Thread-placement %d: threads = %4d, time = %d ms\n",
+                                     m, pcal->get_thnum(), (rt_si32)t);
+
+            if (tmin < 0 || t < tmin)
+            {
+                tmin = t;
+                best = m;
+            }
+
+            delete scal;
+            scal = RT_NULL;
+
+            delete pcal;
+            pcal = RT_NULL;
+        }
+        catch (rt_Exception e)
+        {
+            RT_LOGE("Exception in main_calib, policy %d: %s\n", m, e.err);
+
+            /* release scene's data lock and worker threads
+             * so that main_init can create its own instances */
+            if (scal != RT_NULL)
+            {
+                delete scal;
+            }
+            if (pcal != RT_NULL)
+            {
+                delete pcal;
+            }
+            break;
+        }
+    }
+
+    return best;
+}
+
 /*
  * Initialize event loop.
  */
@@ -1197,12 +1377,46 @@ rt_si32 main_init()
     rt_si32 size, type, simd = 0;
     rt_si32 i, n = RT_ARR_SIZE(sc_rt);
 
+    /* scene loaded from binary file (save_scene)
+     * replaces default demo-scene before calibration */
+    if (j_name != RT_NULL)
+    {
+        try
+        {
+            hp_load = new rt_Heap(sys_alloc, sys_free);
+            sc_load = load_scene(hp_load, j_name, RT_NULL, 0);
+            sc_rt[d] = sc_load;
+        }
+        catch (rt_Exception e)
+        {
+            RT_LOGE("Exception in main_init, scene-file %s: %s\n",
+                    j_name, e.err);
+            return 0;
+        }
+    }
+
+    /* thread-placement is calibrated unless given or pool size is */
+    if (t_mode == 0)
+    {
+        t_mode = t_pool == 0 ? main_calib() : 1;
+        RT_LOGI("Thread-placement selected: %d\n", t_mode);
+    }
+
+    /* huge chunk classes are only used if
+     * system heap backs them with huge pages */
+    if (v_mode != 0)
+    {
+        v_mode = sys_huge(v_mode);
+        RT_LOGI("Heap huge-pages selected: %d\n", v_mode);
+    }
+
     try
     {
         i = -1;
         pfm = new rt_Platform(sys_alloc, sys_free, thnum,
                               init_threads, term_threads,
                               update_scene, render_scene);
+        pfm->set_huge(v_mode);
     }
     catch (rt_Exception e)
     {
@@ -1338,6 +1552,13 @@ rt_si32 main_term()
 
         i = -1;
         delete pfm;
+
+        /* scene instances using scene-file are deleted above */
+        if (sc_load != RT_NULL)
+        {
+            free_scene(sc_load);
+        }
+        delete hp_load;
     }
     catch (rt_Exception e)
     {
@@ -5,6 +5,7 @@
 /******************************************************************************/
 
 #include "RooT.h"
+#include "posix.h"
 
 /******************************************************************************/
 /****************************   PLATFORM - LINUX   ****************************/
@@ -25,94 +26,57 @@ rt_si32     depth;
 #define RT_XSHM 1
 #endif /* RT_XSHM */
 
+#ifndef RT_PRESENT
+#define RT_PRESENT 1 /* 1 - present thread, 0 - present on main thread */
+#endif /* RT_PRESENT */
+
+#if RT_PRESENT
+#define RT_FRAMES 3 /* triple-buffering */
+#else /* RT_PRESENT */
+#define RT_FRAMES 1
+#endif /* RT_PRESENT */
+
 #if RT_XSHM
 #include <sys/shm.h>
 #include <X11/extensions/XShm.h>
 
-XShmSegmentInfo shminfo;
+XShmSegmentInfo shminfo[RT_FRAMES];
 #endif /* RT_XSHM */
 
 rt_bool     xshm        = RT_FALSE;
-XImage     *ximage      = NULL;
+XImage     *ximage[RT_FRAMES] = {0};
 GC          gc;
 XGCValues   gc_values   = {0};
 
 #include <pthread.h>
 
-pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+/* image held by main thread as next render target,
+ * others are on screen (present thread) and in the mailbox in-between */
+rt_si32     x_tgt       = RT_FRAMES - 1;
 
-#ifdef __APPLE__
+#if RT_PRESENT
 
-#undef  RT_XSHM /* XShm compiles on macOS with XQuartz, but fails at runtime */
-#define RT_XSHM 0
+#define RT_INDEX    0x00FF /* mailbox's image index */
+#define RT_FRESH    0x0100 /* mailbox's image is not presented yet */
+#define RT_CLOSE    0x0200 /* present thread is asked to finish */
 
-#undef  RT_SETAFFINITY /* setting thread affinity is not present on macOS */
-#define RT_SETAFFINITY 0
+/* lock-free mailbox for the present thread,
+ * both sides exchange their image with it,
+ * present thread waits on it (posix.h) */
+rt_WAIT             x_mbox;
+pthread_t           x_pthr;
 
-/*
- * Custom implementation of pthread barriers for macOS found at:
- * http://blog.albertarmea.com/post/47089939939/using-pthreadbarrier-on-mac-os-x
- * copied as is with minor format adjustments.
- */
-#include <errno.h>
+rt_pntr present_thread(rt_pntr p);
 
-typedef int pthread_barrierattr_t;
-typedef struct
-{
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-    int count;
-    int tripCount;
-} pthread_barrier_t;
-
-int pthread_barrier_init(pthread_barrier_t *barrier,
-                         const pthread_barrierattr_t *attr, unsigned int count)
-{
-    if(count == 0)
-    {
-        errno = EINVAL;
-        return -1;
-    }
-    if(pthread_mutex_init(&barrier->mutex, 0) < 0)
-    {
-        return -1;
-    }
-    if(pthread_cond_init(&barrier->cond, 0) < 0)
-    {
-        pthread_mutex_destroy(&barrier->mutex);
-        return -1;
-    }
-    barrier->tripCount = count;
-    barrier->count = 0;
+#endif /* RT_PRESENT */
 
-    return 0;
-}
+#ifdef __APPLE__
 
-int pthread_barrier_destroy(pthread_barrier_t *barrier)
-{
-    pthread_cond_destroy(&barrier->cond);
-    pthread_mutex_destroy(&barrier->mutex);
-    return 0;
-}
+#undef  RT_XSHM /* XShm compiles on macOS with XQuartz, but fails at runtime */
+#define RT_XSHM 0
 
-int pthread_barrier_wait(pthread_barrier_t *barrier)
-{
-    pthread_mutex_lock(&barrier->mutex);
-    ++(barrier->count);
-    if(barrier->count >= barrier->tripCount)
-    {
-        barrier->count = 0;
-        pthread_cond_broadcast(&barrier->cond);
-        pthread_mutex_unlock(&barrier->mutex);
-        return 1;
-    }
-    else
-    {
-        pthread_cond_wait(&barrier->cond, &(barrier->mutex));
-        pthread_mutex_unlock(&barrier->mutex);
-        return 0;
-    }
-}
+#undef  RT_SETAFFINITY /* setting thread affinity is not present on macOS */
+#define RT_SETAFFINITY 0
 
 #endif /* __APPLE__ */
 
@@ -197,6 +161,11 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         return 1;
     }
 
+#if RT_PRESENT
+    /* X calls come from both main and present threads */
+    XInitThreads();
+#endif /* RT_PRESENT */
+
     /* open connection to X server */
     disp = XOpenDisplay(NULL);
     if (disp == NULL)
@@ -296,18 +265,20 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     XMapWindow(disp, win);
     XSync(disp, False);
 
+    rt_si32 i, k;
+
 #if RT_XSHM
-    do
+    for (i = 0; i < RT_FRAMES; i++)
     {
         /* create image,
          * use preconfigured x_res, y_res for rendering,
          * window resizing in runtime is not supported for now */
-        ximage = XShmCreateImage(disp,
-                                 DefaultVisual(disp, scr_id),
-                                 depth,
-                                 ZPixmap, NULL, &shminfo,
-                                 x_row, y_res);
-        if (ximage == NULL)
+        ximage[i] = XShmCreateImage(disp,
+                                    DefaultVisual(disp, scr_id),
+                                    depth,
+                                    ZPixmap, NULL, &shminfo[i],
+                                    x_row, y_res);
+        if (ximage[i] == NULL)
         {
             RT_LOGE("Couldn't create XShm image\n");
             RT_LOGE("defaulting to (slower) non-XShm fallback\n");
@@ -315,38 +286,51 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         }
 
         /* get shared memory */
-        shminfo.shmid = shmget(IPC_PRIVATE,
-                               ximage->bytes_per_line * ximage->height,
+        shminfo[i].shmid = shmget(IPC_PRIVATE,
+                               ximage[i]->bytes_per_line * ximage[i]->height,
                                IPC_CREAT|0777);
-        if (shminfo.shmid < 0)
+        if (shminfo[i].shmid < 0)
         {
             RT_LOGE("shmget failed with size = %d bytes\n",
-                                 ximage->bytes_per_line * ximage->height);
+                            ximage[i]->bytes_per_line * ximage[i]->height);
             RT_LOGE("defaulting to (slower) non-XShm fallback\n");
-            XDestroyImage(ximage);
+            XDestroyImage(ximage[i]);
             break;
         }
 
         /* attach shared memory */
-        shminfo.shmaddr = ximage->data = (rt_char *)shmat(shminfo.shmid, 0, 0);
-        if (shminfo.shmaddr == (rt_char *)-1)
+        shminfo[i].shmaddr = ximage[i]->data =
+                                (rt_char *)shmat(shminfo[i].shmid, 0, 0);
+        if (shminfo[i].shmaddr == (rt_char *)-1)
         {
             RT_LOGE("shmat failed\n");
             RT_LOGE("defaulting to (slower) non-XShm fallback\n");
-            XDestroyImage(ximage);
+            XDestroyImage(ximage[i]);
             break;
         }
 
-        shminfo.readOnly = False;
-        XShmAttach(disp, &shminfo);
-        shmctl(shminfo.shmid, IPC_RMID, 0);
+        shminfo[i].readOnly = False;
+        XShmAttach(disp, &shminfo[i]);
+        shmctl(shminfo[i].shmid, IPC_RMID, 0);
+    }
 
+    if (i == RT_FRAMES)
+    {
         xshm = RT_TRUE;
     }
-    while (0);
+    else
+    {
+        /* release images created before the failure */
+        for (k = 0; k < i; k++)
+        {
+            XShmDetach(disp, &shminfo[k]);
+            XDestroyImage(ximage[k]);
+            shmdt(shminfo[k].shmaddr);
+        }
+    }
 #endif /* RT_XSHM */
 
-    if (xshm == RT_FALSE)
+    for (i = 0; i < RT_FRAMES && xshm == RT_FALSE; i++)
     {
         rt_si32 pixel = depth > 16 ? 32 : 16;
         /* only malloc fits XCreateImage as XDestroyImage calls free */
@@ -355,14 +339,18 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         /* create image,
          * use preconfigured x_res, y_res for rendering,
          * window resizing in runtime is not supported for now */
-        ximage = XCreateImage(disp,
-                              DefaultVisual(disp, scr_id),
-                              depth,
-                              ZPixmap, 0, (rt_char *)f_ptr,
-                              x_res, y_res, pixel, x_row * pixel / 8);
-        if (ximage == NULL)
+        ximage[i] = XCreateImage(disp,
+                                 DefaultVisual(disp, scr_id),
+                                 depth,
+                                 ZPixmap, 0, (rt_char *)f_ptr,
+                                 x_res, y_res, pixel, x_row * pixel / 8);
+        if (ximage[i] == NULL)
         {
             RT_LOGE("Couldn't create X image\n");
+            for (k = 0; k < i; k++)
+            {
+                XDestroyImage(ximage[k]);
+            }
             XDestroyWindow(disp, win);
             XCloseDisplay(disp);
             return 1;
@@ -372,27 +360,37 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     gc = XCreateGC(disp, win, 0, &gc_values);
     XSync(disp, False);
 
-    /* use true-color target directly */
+    /* use true-color target directly,
+     * rotated by frame_to_screen if present thread is enabled */
     if (depth > 16)
     {
-        frame = (rt_ui32 *)ximage->data;
-        x_row = ximage->bytes_per_line / 4;
+        frame = (rt_ui32 *)ximage[x_tgt]->data;
+        x_row = ximage[x_tgt]->bytes_per_line / 4;
     }
 
-    /* init sys_alloc's mutex */
-    pthread_mutex_init(&mutex, NULL);
-
     /* run main loop */
     ret = main_init();
     if (ret == 0)
     {
         return 1;
     }
+
+#if RT_PRESENT
+    wait_init(&x_mbox, 1);
+    pthread_create(&x_pthr, NULL, present_thread, NULL);
+#endif /* RT_PRESENT */
+
     ret = main_loop();
-    ret = main_term();
 
-    /* destroy sys_alloc's mutex */
-    pthread_mutex_destroy(&mutex);
+#if RT_PRESENT
+    /* finish present thread before images are destroyed */
+    __sync_fetch_and_or(&x_mbox.word, RT_CLOSE);
+    wait_wake(&x_mbox);
+    pthread_join(x_pthr, NULL);
+    wait_term(&x_mbox);
+#endif /* RT_PRESENT */
+
+    ret = main_term();
 
     if (w_size == 0)
     {
@@ -400,21 +398,24 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         XDefineCursor(disp, win, None);
     }
 
-#if RT_XSHM
-    if (xshm == RT_TRUE)
+    for (i = 0; i < RT_FRAMES; i++)
     {
-        /* destroy image,
-         * detach shared memory */
-        XShmDetach(disp, &shminfo);
-        XDestroyImage(ximage);
-        shmdt(shminfo.shmaddr);
-    }
+#if RT_XSHM
+        if (xshm == RT_TRUE)
+        {
+            /* destroy image,
+             * detach shared memory */
+            XShmDetach(disp, &shminfo[i]);
+            XDestroyImage(ximage[i]);
+            shmdt(shminfo[i].shmaddr);
+        }
 #endif /* RT_XSHM */
 
-    if (xshm == RT_FALSE)
-    {
-        /* destroy image */
-        XDestroyImage(ximage);
+        if (xshm == RT_FALSE)
+        {
+            /* destroy image */
+            XDestroyImage(ximage[i]);
+        }
     }
 
     XFreeGC(disp, gc);
@@ -428,316 +429,26 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     return 0;
 }
 
-/*
- * Get system time in milliseconds.
- */
-rt_time get_time()
-{
-    timeval tm;
-    gettimeofday(&tm, NULL);
-    return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
-}
-
-
-#if RT_POINTER == 64
-#if RT_ADDRESS == 32
-
-#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000040000000)
-#define RT_ADDRESS_MAX      ((rt_byte *)0x0000000080000000)
-
-#else /* RT_ADDRESS == 64 */
-
-#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000140000000)
-#define RT_ADDRESS_MAX      ((rt_byte *)0x0000080000000000)
-
-#endif /* RT_ADDRESS */
-
-static
-rt_byte *s_ptr = RT_ADDRESS_MIN;
-
-#endif /* RT_POINTER */
-
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-#include <sys/mman.h>
-
-#ifndef MAP_ANONYMOUS
-#define MAP_ANONYMOUS MAP_ANON  /* workaround for macOS compilation */
-#endif /* macOS still cannot allocate with mmap within 32-bit range */
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-/*
- * Allocate memory from system heap.
- */
-rt_pntr sys_alloc(rt_size size)
-{
-    pthread_mutex_lock(&mutex);
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    /* loop around RT_ADDRESS_MAX boundary */
-    /* in 64/32-bit hybrid mode addresses can't have sign bit
-     * as MIPS64 sign-extends all 32-bit mem-loads by default */
-    if (s_ptr >= RT_ADDRESS_MAX - size)
-    {
-        s_ptr  = RT_ADDRESS_MIN;
-    }
-
-    rt_pntr ptr = mmap(s_ptr, size, PROT_READ | PROT_WRITE,
-                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-
-    /* advance with allocation granularity */
-    /* in case when page-size differs from default 4096 bytes
-     * mmap should round toward closest correct page boundary */
-    s_ptr = (rt_byte *)ptr + ((size + 4095) / 4096) * 4096;
-
-#else /* (RT_POINTER - RT_ADDRESS) */
-
-    rt_pntr ptr = malloc(size);
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-#if RT_DEBUG >= 2
-
-    RT_LOGI("ALLOC PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
-
-#endif /* RT_DEBUG */
-
-    pthread_mutex_unlock(&mutex);
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
-    {
-        throw rt_Exception("address exceeded allowed range in sys_alloc");
-    }
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-    if (ptr == RT_NULL)
-    {
-        throw rt_Exception("alloc failed with NULL address in sys_alloc");
-    }
-
-    return ptr;
-}
-
-/*
- * Free memory from system heap.
- */
-rt_void sys_free(rt_pntr ptr, rt_size size)
-{
-    pthread_mutex_lock(&mutex);
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    munmap(ptr, size);
-
-#else /* (RT_POINTER - RT_ADDRESS) */
-
-    free(ptr);
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-#if RT_DEBUG >= 2
-
-    RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
-
-#endif /* RT_DEBUG */
-
-    pthread_mutex_unlock(&mutex);
-}
-
 /******************************************************************************/
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
 
-struct rt_THREAD;
-
-/* platform-specific pool
- * of "thnum" threads */
-struct rt_THREAD_POOL
-{
-    rt_Platform        *pfm;
-    rt_si32             cmd;
-    rt_si32             thnum;
-    rt_THREAD          *thread;
-    pthread_barrier_t   barr[2];
-};
-
-/* platform-specific thread */
-struct rt_THREAD
-{
-    rt_THREAD_POOL     *tpool;
-    rt_si32             index;
-    pthread_t           pthr;
-};
-
 /*
- * Worker thread's entry point.
+ * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback),
+ * threads are placed according to t_mode (from command-line).
  */
-rt_pntr worker_thread(rt_pntr p)
+rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
 {
-    rt_THREAD *thread = (rt_THREAD *)p;
-    rt_si32 ti = thread->index;
-
-    while (thread->tpool->cmd < 0) /* <- wait for barriers */
-    {
-        sched_yield();
-    }
-
-    while (1)
-    {
-        /* every worker-thread waits signal from main thread */
-        pthread_barrier_wait(&thread->tpool->barr[0]);
-
-        rt_Platform *pfm = thread->tpool->pfm;
-
-        if (pfm == RT_NULL)
-        {
-            break;
-        }
-
-        rt_si32 cmd = thread->tpool->cmd;
-
-        /* if one thread throws an exception,
-         * other threads are still allowed to proceed
-         * in the same run, but not in the next one */
-        if (eout == 0)
-        try
-        {
-            rt_Scene *scene = pfm->get_cur_scene();
-
-            switch (cmd & 0x3)
-            {
-                case 1:
-                scene->update_slice(ti, (cmd >> 2) & 0xFF);
-                break;
-
-                case 2:
-                scene->render_slice(ti, (cmd >> 2) & 0xFF);
-                break;
-
-                default:
-                break;
-            };
-        }
-        catch (rt_Exception e)
-        {
-            estr[ti] = e.err;
-            eout = 1;
-        }
-
-        /* every worker-thread signals to main thread when done */
-        pthread_barrier_wait(&thread->tpool->barr[1]);
-    }
-
-    /* every worker-thread signals to main thread when done */
-    pthread_barrier_wait(&thread->tpool->barr[1]);
-
-    return RT_NULL;
+    return pool_init(thnum, pfm, t_mode);
 }
 
 /*
- * Initialize platform-specific pool of "thnum" threads (< 0 - no feedback).
+ * Return the number of threads placed by "mode" (1 - per cpu, 2 - per core,
+ * 3 - per L3-domain) on available CPUs, 0 if placement is not supported.
  */
-rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
+rt_si32 topo_threads(rt_si32 mode)
 {
-    rt_bool feedback = thnum < 0 ? RT_FALSE : RT_TRUE;
-    thnum = thnum < 0 ? -thnum : thnum;
-
-    eout = 0; emax = thnum;
-    estr = (rt_pstr *)malloc(sizeof(rt_pstr) * thnum);
-
-    if (estr == RT_NULL)
-    {
-        throw rt_Exception("out of memory for estr in init_threads");
-    }
-
-    memset(estr, 0, sizeof(rt_pstr) * thnum);
-
-#if RT_SETAFFINITY
-
-    cpu_set_t cpuset_pr, cpuset_th;
-    pthread_t pthr = pthread_self();
-    pthread_getaffinity_np(pthr, sizeof(cpu_set_t), &cpuset_pr);
-
-#endif /* RT_SETAFFINITY */
-
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)malloc(sizeof(rt_THREAD_POOL));
-
-    if (tpool == RT_NULL)
-    {
-        throw rt_Exception("out of memory for tpool in init_threads");
-    }
-
-    tpool->pfm = pfm;
-    tpool->cmd = -1;
-    tpool->thnum = thnum;
-    tpool->thread = (rt_THREAD *)malloc(sizeof(rt_THREAD) * thnum);
-
-    if (tpool->thread == RT_NULL)
-    {
-        throw rt_Exception("out of memory for thread data in init_threads");
-    }
-
-    rt_si32 i, a;
-
-    for (i = 0, a = 0; i < thnum; i++, a++)
-    {
-#if RT_SETAFFINITY
-
-        while (!CPU_ISSET(a, &cpuset_pr))
-        {
-            a++;
-            if (a == CPU_SETSIZE)
-            {
-                if (feedback)
-                {
-                    thnum = i;
-                    break;
-                }
-                else
-                {
-                    a = 0;
-                }
-            }
-        }
-        if (thnum == i)
-        {
-            break;
-        }
-
-#endif /* RT_SETAFFINITY */
-
-        rt_THREAD *thread = tpool->thread;
-
-        thread[i].tpool = tpool;
-        thread[i].index = i;
-        pthread_create(&thread[i].pthr, NULL, worker_thread, &thread[i]);
-
-#if RT_SETAFFINITY
-
-        CPU_ZERO(&cpuset_th);
-        CPU_SET(a, &cpuset_th);
-        pthread_setaffinity_np(thread[i].pthr, sizeof(cpu_set_t), &cpuset_th);
-
-#endif /* RT_SETAFFINITY */
-    }
-
-    pthread_barrier_init(&tpool->barr[0], NULL, thnum + 1);
-    pthread_barrier_init(&tpool->barr[1], NULL, thnum + 1);
-
-    if (feedback)
-    {
-        pfm->set_thnum(thnum);
-    }
-    tpool->thnum = thnum;
-    tpool->cmd = 0;
-
-    return tpool;
+    return pool_topo(mode);
 }
 
 /*
@@ -745,32 +456,7 @@ rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
  */
 rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
 {
-    rt_si32 i;
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to terminate */
-    tpool->cmd = 0;
-    tpool->pfm = RT_NULL;
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
-
-    for (i = 0; i < tpool->thnum; i++)
-    {
-        rt_THREAD *thread = tpool->thread;
-
-        pthread_join(thread[i].pthr, NULL);
-    }
-
-    pthread_barrier_destroy(&tpool->barr[0]);
-    pthread_barrier_destroy(&tpool->barr[1]);
-
-    free(tpool->thread);
-    free(tpool);
-
-    free(estr);
-    estr = RT_NULL;
-    eout = emax = 0;
+    pool_term(tdata, thnum);
 }
 
 /*
@@ -779,28 +465,16 @@ rt_void term_threads(rt_pntr tdata, rt_si32 thnum)
  */
 rt_void update_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 {
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to update scene */
-    tpool->cmd = 1 | ((phase & 0xFF) << 2);
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
+    pool_update(tdata, thnum, phase);
 }
 
 /*
  * Task platform-specific pool of "thnum" threads to render scene,
- * block until finished.
+ * block until finished ("phase" < 0 - don't block, 0 - block only).
  */
 rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 {
-    rt_THREAD_POOL *tpool = (rt_THREAD_POOL *)tdata;
-
-    /* signal all worker-threads to render scene */
-    tpool->cmd = 2 | ((phase & 0xFF) << 2);
-    pthread_barrier_wait(&tpool->barr[0]);
-    /* wait for all worker-threads to finish */
-    pthread_barrier_wait(&tpool->barr[1]);
+    pool_render(tdata, thnum, phase);
 }
 
 /******************************************************************************/
@@ -808,14 +482,11 @@ rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 /******************************************************************************/
 
 /*
- * Set current frame to screen.
+ * Convert frame to image "k" unless it is rendered there already.
  */
-rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+rt_void frame_to_image(rt_ui32 *frame, rt_si32 x_row, rt_si32 k)
 {
-    if (frame == RT_NULL)
-    {
-        return;
-    }
+    XImage *ximage = ::ximage[k];
 
     if (depth == 16)
     {
@@ -835,7 +506,7 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
         }
     }
     else
-    if (frame != ::frame)
+    if (frame != (rt_ui32 *)ximage->data)
     {
         rt_si32 i;
 
@@ -847,6 +518,14 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
             memcpy(idata, frame + i * x_row, x_res * sizeof(rt_ui32));
         }
     }
+}
+
+/*
+ * Put image "k" to the screen.
+ */
+rt_void image_to_screen(rt_si32 k)
+{
+    XImage *ximage = ::ximage[k];
 
 #if RT_XSHM
     if (xshm == RT_TRUE)
@@ -865,6 +544,87 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
     XSync(disp, False);
 }
 
+#if RT_PRESENT
+
+/*
+ * Present thread's entry point, puts to the screen the latest image
+ * from the mailbox, exchanging it for the one presented before.
+ * Waiting thread spins with CPU relax hint for a while before sleeping
+ * on futex (or on condition variable if futex is not present).
+ */
+rt_pntr present_thread(rt_pntr p)
+{
+    rt_si32 m, k = 0; /* image on the screen */
+
+    while (1)
+    {
+        /* only main thread changes the mailbox
+         * while it holds no fresh image */
+        while (((m = x_mbox.word) & (RT_FRESH | RT_CLOSE)) == 0)
+        {
+            wait_word(&x_mbox, m);
+        }
+
+        m = __sync_lock_test_and_set(&x_mbox.word, k);
+        __sync_synchronize();
+
+        if (m & RT_CLOSE)
+        {
+            break;
+        }
+
+        k = m & RT_INDEX;
+        image_to_screen(k);
+    }
+
+    return RT_NULL;
+}
+
+#endif /* RT_PRESENT */
+
+/*
+ * Set current frame to screen, return framebuffer for the next frame
+ * if present thread is enabled (NULL otherwise). Frame rendered to
+ * one of main thread's images is handed to the present thread as is,
+ * main thread gets back the image the mailbox held before (either
+ * dropped or presented), thus rendering never waits for the screen.
+ */
+rt_ui32* frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+{
+    if (frame == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+#if RT_PRESENT
+
+    rt_si32 m;
+
+    /* frame not rendered to the target image directly
+     * (not taken by set_frame) is copied there first */
+    if (frame != (rt_ui32 *)ximage[x_tgt]->data)
+    {
+        frame_to_image(frame, x_row, x_tgt);
+    }
+
+    __sync_synchronize();
+    m = __sync_lock_test_and_set(&x_mbox.word, x_tgt | RT_FRESH);
+    wait_wake(&x_mbox);
+
+    x_tgt = m & RT_INDEX;
+
+    return depth > 16 ? (rt_ui32 *)ximage[x_tgt]->data : RT_NULL;
+
+#else /* RT_PRESENT */
+
+    frame_to_image(frame, x_row, x_tgt);
+    image_to_screen(x_tgt);
+
+    return RT_NULL;
+
+#endif /* RT_PRESENT */
+}
+
 /*
  * Implementation of the event loop.
  */
@@ -11,9 +11,12 @@ INC_PATH =                                  \
 
 SRC_LIST =                                  \
         ../core/engine/engine.cpp           \
+        ../core/engine/farm.cpp             \
         ../core/engine/object.cpp           \
         ../core/engine/rtgeom.cpp           \
         ../core/engine/rtimag.cpp           \
+        ../core/engine/rtscen.cpp           \
+        ../core/system/posix.cpp            \
         ../core/system/system.cpp           \
         ../core/tracer/tracer.cpp           \
         ../core/tracer/tracer_128v2.cpp     \
@@ -283,8 +283,11 @@ rt_time get_time()
 #if RT_POINTER == 64
 #if RT_ADDRESS == 32
 
-#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000040000000)
-#define RT_ADDRESS_MAX      ((rt_byte *)0x0000000080000000)
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000010000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)RT_ADDRESS_TOP)
+
+/* hint step past foreign mappings */
+#define RT_ADDRESS_STEP     0x0000000001000000
 
 #else /* RT_ADDRESS == 64 */
 
@@ -311,11 +314,8 @@ rt_pntr sys_alloc(rt_size size)
 
 #if (RT_POINTER - RT_ADDRESS) != 0
 
-    /* loop around RT_ADDRESS_MAX boundary */
-    if (s_ptr >= RT_ADDRESS_MAX - size)
-    {
-        s_ptr  = RT_ADDRESS_MIN;
-    }
+    rt_pntr ptr = RT_NULL;
+    rt_si32 wrap = 0;
 
     if (s_step == 0)
     {
@@ -323,11 +323,34 @@ rt_pntr sys_alloc(rt_size size)
         s_step = s_sys.dwAllocationGranularity;
     }
 
-    rt_pntr ptr = VirtualAlloc(s_ptr, size, MEM_COMMIT | MEM_RESERVE,
-                  PAGE_READWRITE);
+    /* in 64/32-bit hybrid mode addresses can't exceed RT_ADDRESS_TOP
+     * (rtbase.h), requested address skips past regions already in use
+     * and loops around RT_ADDRESS_MAX boundary at most once */
+    while (wrap < 2 && size < RT_ADDRESS_MAX - RT_ADDRESS_MIN)
+    {
+        if (s_ptr >= RT_ADDRESS_MAX - size)
+        {
+            s_ptr  = RT_ADDRESS_MIN;
+            wrap++;
+            continue;
+        }
+
+        ptr = VirtualAlloc(s_ptr, size, MEM_COMMIT | MEM_RESERVE,
+                           PAGE_READWRITE);
+
+        if (ptr != RT_NULL)
+        {
+            break;
+        }
+
+        s_ptr += RT_ADDRESS_STEP;
+    }
 
     /* advance with allocation granularity */
-    s_ptr = (rt_byte *)ptr + ((size + s_step - 1) / s_step) * s_step;
+    if (ptr != RT_NULL)
+    {
+        s_ptr = (rt_byte *)ptr + ((size + s_step - 1) / s_step) * s_step;
+    }
 
 #else /* (RT_POINTER - RT_ADDRESS) */
 
@@ -343,15 +366,6 @@ rt_pntr sys_alloc(rt_size size)
 
     LeaveCriticalSection(&critSec);
 
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
-    {
-        throw rt_Exception("address exceeded allowed range in sys_alloc");
-    }
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
     if (ptr == RT_NULL)
     {
         throw rt_Exception("alloc failed with NULL address in sys_alloc");
@@ -386,6 +400,17 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
     LeaveCriticalSection(&critSec);
 }
 
+/*
+ * Set huge-page mode for allocations of whole huge pages,
+ * return the mode applied (0 if not supported).
+ */
+rt_si32 sys_huge(rt_si32 mode)
+{
+    /* large pages on Windows require SeLockMemoryPrivilege,
+     * not supported in this front-end */
+    return 0;
+}
+
 /******************************************************************************/
 /*****************************   MULTI-THREADING   ****************************/
 /******************************************************************************/
@@ -757,6 +782,17 @@ rt_pntr init_threads(rt_si32 thnum, rt_Platform *pfm)
     return tpool;
 }
 
+/*
+ * Return the number of threads placed by "mode" (1 - per cpu, 2 - per core,
+ * 3 - per L3-domain) on available CPUs, 0 if placement is not supported.
+ */
+rt_si32 topo_threads(rt_si32 mode)
+{
+    /* threads are placed per cpu in affinity groups,
+     * placement modes are not supported in this front-end */
+    return 0;
+}
+
 /*
  * Terminate platform-specific pool of "thnum" threads.
  */
@@ -838,13 +874,13 @@ rt_void render_scene(rt_pntr tdata, rt_si32 thnum, rt_si32 phase)
 /******************************************************************************/
 
 /*
- * Set current frame to screen.
+ * Set current frame to screen, framebuffer stays the same (returns NULL).
  */
-rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
+rt_ui32* frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
 {
     if (frame == RT_NULL)
     {
-        return;
+        return RT_NULL;
     }
 
     if (frame != ::frame)
@@ -861,6 +897,8 @@ rt_void frame_to_screen(rt_ui32 *frame, rt_si32 x_row)
 
     SetDIBitsToDevice(hWndDC, 0, 0, x_res, y_res, 0, 0, 0, y_res,
                                   ::frame, &DIBinfo, DIB_RGB_COLORS);
+
+    return RT_NULL;
 }
 
 /*
@@ -8,14 +8,17 @@
 #include <string.h>
 
 #include "engine.h"
+#include "farm.h"
 #include "rtimag.h"
+#include "rtscen.h"
 
 /******************************************************************************/
 /*******************************   DEFINITIONS   ******************************/
 /******************************************************************************/
 
-#define SUB_TEST            18
+#define SUB_TEST            19
 #define CYC_SIZE            3
+#define FRM_THNUM           4
 
 #define RT_X_RES            800
 #define RT_Y_RES            480
@@ -40,8 +43,10 @@ rt_si32     x_res       = RT_X_RES;
 rt_si32     y_res       = RT_Y_RES;
 rt_si32     x_row       = (RT_X_RES+RT_SIMD_WIDTH-1) & ~(RT_SIMD_WIDTH-1);
 rt_ui32    *frame       = RT_NULL;
+rt_ui32    *fkeep       = RT_NULL;
 
 rt_Scene   *scene       = RT_NULL;
+rt_Farm    *farm        = RT_NULL;
 
 rt_si32     n_init      = 0;            /* subtest-init (from command-line) */
 rt_si32     n_done      = SUB_TEST-1;   /* subtest-done (from command-line) */
@@ -61,6 +66,10 @@ rt_bool     l_mode      = RT_FALSE;     /* log-off mode (from command-line) */
 rt_bool     o_mode      = RT_FALSE;     /* optimal mode (from command-line) */
 rt_bool     q_mode      = RT_FALSE;     /* quality mode (from command-line) */
 rt_bool     q_test      = RT_FALSE;     /* quality mode (from actual scene) */
+rt_bool     m_mode      = RT_FALSE;     /* packing mode (from command-line) */
+rt_bool     r_mode      = RT_FALSE;      /* reload mode (from command-line) */
+rt_bool     r_file      = RT_FALSE;      /* reload mode (from current run) */
+rt_bool     u_farm      = RT_FALSE;        /* farm mode (from current run) */
 rt_si32     a_mode      = RT_FSAA_NO;   /* antialiasing (from command-line) */
 
 /*
@@ -186,6 +195,37 @@ rt_void frame_max(rt_ui32 *fd)
  */
 rt_Platform pfm(sys_alloc, sys_free);
 
+/*
+ * Scene data loaded from binary file.
+ */
+rt_SCENE *s_load = RT_NULL;
+
+/*
+ * Instantiate scene "scn" of subtest "n", save and load it
+ * through binary scene file first if reload mode is enabled,
+ * instantiate it within render farm if farm mode is enabled.
+ */
+rt_Scene* scene_new(rt_SCENE *scn, rt_si32 n)
+{
+    if (r_file)
+    {
+        rt_char name[32];
+        sprintf(name, RT_PATH_DUMP "scn_test%02d.bin", n);
+
+        save_scene(&pfm, name, scn, RT_NULL, 0);
+        s_load = load_scene(&pfm, name, RT_NULL, 0);
+        scn = s_load;
+    }
+
+    if (u_farm)
+    {
+        farm = new rt_Farm(scn, x_res, y_res, FRM_THNUM);
+        return farm->get_scene();
+    }
+
+    return new(&pfm) rt_Scene(scn, x_res, y_res, x_row, RT_NULL, &pfm);
+}
+
 /******************************************************************************/
 /*******************************   SUB TEST  1   ******************************/
 /******************************************************************************/
@@ -196,8 +236,7 @@ rt_Platform pfm(sys_alloc, sys_free);
 
 rt_void o_test01()
 {
-    scene = new(&pfm) rt_Scene(&scn_test01::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test01::sc_root, 1);
 }
 
 #endif /* SUB_TEST  1 */
@@ -212,8 +251,7 @@ rt_void o_test01()
 
 rt_void o_test02()
 {
-    scene = new(&pfm) rt_Scene(&scn_test02::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test02::sc_root, 2);
 }
 
 #endif /* SUB_TEST  2 */
@@ -228,8 +266,7 @@ rt_void o_test02()
 
 rt_void o_test03()
 {
-    scene = new(&pfm) rt_Scene(&scn_test03::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test03::sc_root, 3);
 }
 
 #endif /* SUB_TEST  3 */
@@ -244,8 +281,7 @@ rt_void o_test03()
 
 rt_void o_test04()
 {
-    scene = new(&pfm) rt_Scene(&scn_test04::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test04::sc_root, 4);
 }
 
 #endif /* SUB_TEST  4 */
@@ -260,8 +296,7 @@ rt_void o_test04()
 
 rt_void o_test05()
 {
-    scene = new(&pfm) rt_Scene(&scn_test05::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test05::sc_root, 5);
 }
 
 #endif /* SUB_TEST  5 */
@@ -276,8 +311,7 @@ rt_void o_test05()
 
 rt_void o_test06()
 {
-    scene = new(&pfm) rt_Scene(&scn_test06::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test06::sc_root, 6);
 }
 
 #endif /* SUB_TEST  6 */
@@ -292,8 +326,7 @@ rt_void o_test06()
 
 rt_void o_test07()
 {
-    scene = new(&pfm) rt_Scene(&scn_test07::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test07::sc_root, 7);
 }
 
 #endif /* SUB_TEST  7 */
@@ -308,8 +341,7 @@ rt_void o_test07()
 
 rt_void o_test08()
 {
-    scene = new(&pfm) rt_Scene(&scn_test08::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test08::sc_root, 8);
 }
 
 #endif /* SUB_TEST  8 */
@@ -324,8 +356,7 @@ rt_void o_test08()
 
 rt_void o_test09()
 {
-    scene = new(&pfm) rt_Scene(&scn_test09::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test09::sc_root, 9);
 }
 
 #endif /* SUB_TEST  9 */
@@ -340,8 +371,7 @@ rt_void o_test09()
 
 rt_void o_test10()
 {
-    scene = new(&pfm) rt_Scene(&scn_test10::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test10::sc_root, 10);
 }
 
 #endif /* SUB_TEST 10 */
@@ -356,8 +386,7 @@ rt_void o_test10()
 
 rt_void o_test11()
 {
-    scene = new(&pfm) rt_Scene(&scn_test11::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test11::sc_root, 11);
 }
 
 #endif /* SUB_TEST 11 */
@@ -372,8 +401,7 @@ rt_void o_test11()
 
 rt_void o_test12()
 {
-    scene = new(&pfm) rt_Scene(&scn_test12::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test12::sc_root, 12);
 }
 
 #endif /* SUB_TEST 12 */
@@ -388,8 +416,7 @@ rt_void o_test12()
 
 rt_void o_test13()
 {
-    scene = new(&pfm) rt_Scene(&scn_test13::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test13::sc_root, 13);
 }
 
 #endif /* SUB_TEST 13 */
@@ -404,8 +431,7 @@ rt_void o_test13()
 
 rt_void o_test14()
 {
-    scene = new(&pfm) rt_Scene(&scn_test14::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test14::sc_root, 14);
 }
 
 #endif /* SUB_TEST 14 */
@@ -420,8 +446,7 @@ rt_void o_test14()
 
 rt_void o_test15()
 {
-    scene = new(&pfm) rt_Scene(&scn_test15::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test15::sc_root, 15);
 }
 
 #endif /* SUB_TEST 15 */
@@ -436,8 +461,7 @@ rt_void o_test15()
 
 rt_void o_test16()
 {
-    scene = new(&pfm) rt_Scene(&scn_test16::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test16::sc_root, 16);
 }
 
 #endif /* SUB_TEST 16 */
@@ -452,8 +476,7 @@ rt_void o_test16()
 
 rt_void o_test17()
 {
-    scene = new(&pfm) rt_Scene(&scn_test17::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test17::sc_root, 17);
 }
 
 #endif /* SUB_TEST 17 */
@@ -468,12 +491,26 @@ rt_void o_test17()
 
 rt_void o_test18()
 {
-    scene = new(&pfm) rt_Scene(&scn_test18::sc_root,
-                               x_res, y_res, x_row, RT_NULL, &pfm);
+    scene = scene_new(&scn_test18::sc_root, 18);
 }
 
 #endif /* SUB_TEST 18 */
 
+/******************************************************************************/
+/*******************************   SUB TEST 19   ******************************/
+/******************************************************************************/
+
+#if SUB_TEST >= 19
+
+#include "scn_test19.h"
+
+rt_void o_test19()
+{
+    scene = scene_new(&scn_test19::sc_root, 19);
+}
+
+#endif /* SUB_TEST 19 */
+
 /******************************************************************************/
 /*********************************   TABLES   *********************************/
 /******************************************************************************/
@@ -553,6 +590,10 @@ testXX o_test[SUB_TEST] =
 #if SUB_TEST >= 18
     o_test18,
 #endif /* SUB_TEST 18 */
+
+#if SUB_TEST >= 19
+    o_test19,
+#endif /* SUB_TEST 19 */
 };
 
 /******************************************************************************/
@@ -595,6 +636,8 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
         RT_LOGI(" -l, enable log-off mode, no printing to file and screen\n");
         RT_LOGI(" -o, enable optimal mode, omit unoptimized rendering run\n");
         RT_LOGI(" -q, enable quality mode, activate path-tracing lighting\n");
+        RT_LOGI(" -m, enable packing mode, pack 2D pixel blocks into SIMD\n");
+        RT_LOGI(" -r, enable reload mode, save & map binary scene in run1\n");
         RT_LOGI(" -a, enable 4x antialiasing by default, 8x not supported\n");
         RT_LOGI(" -a n, enable antialiasing, 2 for 2x, 4 for 4x, 8 for 8x\n");
         RT_LOGI(" -t tex1 tex2 texn, convert images in data/textures/tex*\n");
@@ -881,6 +924,16 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
             q_mode = RT_TRUE;
             if (!l_mode) RT_LOGI("Quality mode enabled: %d\n", q_mode);
         }
+        if (k < argc && strcmp(argv[k], "-m") == 0 && !m_mode)
+        {
+            m_mode = RT_TRUE;
+            if (!l_mode) RT_LOGI("Packing mode enabled: %d\n", m_mode);
+        }
+        if (k < argc && strcmp(argv[k], "-r") == 0 && !r_mode)
+        {
+            r_mode = RT_TRUE;
+            if (!l_mode) RT_LOGI("Reload mode enabled: %d\n", r_mode);
+        }
         if (k < argc && strcmp(argv[k], "-a") == 0)
         {
             rt_si32 aa_map[10] =
@@ -957,6 +1010,7 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
     n_simd = simd;
 
     frame = (rt_ui32 *)sys_alloc(x_row * y_res * sizeof(rt_ui32));
+    fkeep = (rt_ui32 *)sys_alloc(x_row * y_res * sizeof(rt_ui32));
 
     if (!l_mode)
     {
@@ -992,6 +1046,7 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             scene->set_opts(RT_OPTS_NONE);
             q_test = scene->set_pton(q_mode);
+            (&pfm)->set_pack(RT_PACK_NO);
 
             time1 = get_time();
 
@@ -1028,10 +1083,13 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             /* ------------ test run1 ---------- */
 
+            r_file = r_mode;
             o_test[i]();
+            r_file = RT_FALSE;
 
             scene->set_opts(RT_OPTS_FULL);
             q_test = scene->set_pton(q_mode);
+            (&pfm)->set_pack(m_mode ? RT_PACK_2D : RT_PACK_NO);
 
             time1 = get_time();
 
@@ -1044,6 +1102,32 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
             tF = time2 - time1;
             if (!l_mode) RT_LOGI("Time F = %d\n", (rt_si32)tF);
 
+            /* keep frame for run2 (before numbers are drawn) */
+            frame_cpy(fkeep, scene->get_frame());
+
+#if RT_PROFILE != 0
+            rt_PROFILE *prof = scene->get_prof();
+            if (!l_mode)
+            {
+                /* last frame's timers (us) and counters */
+                RT_LOGI("Prof U = %d %d %d %d %d %d %d\n",
+                    (rt_si32)prof->t_upd[0], (rt_si32)prof->t_upd[1],
+                    (rt_si32)prof->t_upd[2], (rt_si32)(prof->t_upd[5] +
+                    prof->t_upd[6] + prof->t_upd[7]), (rt_si32)prof->t_upd[3],
+                    (rt_si32)prof->t_upd[4], (rt_si32)prof->t_upd[8]);
+                RT_LOGI("Prof T = %d, R = %d (%d busy, %d idle in thread 0)\n",
+                    (rt_si32)prof->t_tls, (rt_si32)prof->t_rnd,
+                    (rt_si32)prof->t_thr[0], (rt_si32)prof->t_idl[0]);
+                RT_LOGI("Prof P = %d %d %d %d %d, B = %d, S = %d %d %d\n",
+                    (rt_si32)prof->n_prm, (rt_si32)prof->n_shd,
+                    (rt_si32)prof->n_rfl, (rt_si32)prof->n_rfr,
+                    (rt_si32)prof->n_pth, (rt_si32)prof->n_bvt,
+                    (rt_si32)prof->n_srf[RT_TAG_PLANE],
+                    (rt_si32)prof->n_srf[RT_TAG_CYLINDER],
+                    (rt_si32)prof->n_srf[RT_TAG_SPHERE]);
+            }
+#endif /* RT_PROFILE */
+
             if (h_mode)
             {
                 scene->render_num(x_res-30, 10, -1, 2, 0);
@@ -1082,6 +1166,38 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
             delete scene;
             scene = RT_NULL;
+
+            if (s_load != RT_NULL)
+            {
+                free_scene(s_load);
+                s_load = RT_NULL;
+            }
+
+            if (!o_mode)
+            { /* -->---->-- skip run2 -->---->-- */
+
+            /* ------------ test run2 ---------- */
+
+            /* lists rebuilt every frame without RT_OPTS_RETAIN
+             * (camera's list in multi-threaded update phase)
+             * must render the same frame as retained ones in run1 */
+            o_test[i]();
+
+            scene->set_opts(RT_OPTS_FULL & ~RT_OPTS_RETAIN);
+            q_test = scene->set_pton(q_mode);
+            (&pfm)->set_pack(m_mode ? RT_PACK_2D : RT_PACK_NO);
+
+            for (j = 0; j < r_test; j++)
+            {
+                scene->render(q_test ? 0 : j * f_time);
+            }
+
+            frame_cmp(fkeep, scene->get_frame());
+
+            delete scene;
+            scene = RT_NULL;
+
+            } /* --<----<-- skip run2 --<----<-- */
         }
         catch (rt_Exception e)
         {
@@ -1093,6 +1209,74 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
                             q_test ? "q " : "--", n_simd * 128, k_size, s_type);
     }
 
+    /* ------------ farm run ----------- */
+
+    /* render last subtest's frames with the common platform and
+     * with the render farm (own thread pool) to caller's buffer,
+     * last frames of the two runs are compared */
+    rt_ui32 *fout = (rt_ui32 *)sys_alloc(x_row * y_res * sizeof(rt_ui32));
+    rt_time  f_tm[2] = {0, f_time}, f_us[2] = {0, 0};
+    rt_ui32 *f_fr[2] = {fout, fout};
+
+    i = n_done;
+
+    if (!l_mode)
+    RT_LOGI("--------------------  FARM TEST = %2d  - ptr/fp = %d%s%d --\n",
+                    i+1, RT_POINTER, RT_ADDRESS == 32 ? "_" : "f", RT_ELEMENT);
+    try
+    {
+        o_test[i]();
+
+        scene->set_opts(RT_OPTS_FULL);
+        scene->set_pton(RT_FALSE);
+        (&pfm)->set_simd(simd_init(n_simd, s_type, k_size));
+        (&pfm)->set_fsaa(a_mode);
+        (&pfm)->set_pack(RT_PACK_NO);
+
+        for (j = 0; j < 2; j++)
+        {
+            scene->render(f_tm[j]);
+        }
+
+        frame_cpy(frame, scene->get_frame());
+
+        delete scene;
+        scene = RT_NULL;
+
+        u_farm = RT_TRUE;
+        o_test[i]();
+        u_farm = RT_FALSE;
+
+        rt_Platform *fpfm = farm->get_platform();
+
+        scene->set_opts(RT_OPTS_FULL);
+        scene->set_pton(RT_FALSE);
+        fpfm->set_simd(simd_init(n_simd, s_type, k_size));
+        fpfm->set_fsaa(a_mode);
+        fpfm->set_pack(RT_PACK_NO);
+
+        farm->render(2, f_tm, RT_NULL, f_fr, x_row, f_us);
+
+        if (!l_mode)
+        RT_LOGI("Time U = %d, %d threads\n",
+                    (rt_si32)((f_us[0] + f_us[1]) / 1000), fpfm->get_thnum());
+
+        frame_cmp(frame, fout);
+
+        delete farm;
+        farm = RT_NULL;
+        scene = RT_NULL;
+    }
+    catch (rt_Exception e)
+    {
+        if (!l_mode) RT_LOGE("Exception in farm test %d: %s\n", i+1, e.err);
+    }
+    if (!l_mode)
+    RT_LOGI("-------------------------------------- simd = %4dx%dv%d -\n",
+                                               n_simd * 128, k_size, s_type);
+
+    sys_free(fout, x_row * y_res * sizeof(rt_ui32));
+    sys_free(fkeep, x_row * y_res * sizeof(rt_ui32));
     sys_free(frame, x_row * y_res * sizeof(rt_ui32));
 
 #if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
@@ -1113,11 +1297,18 @@ rt_si32 main(rt_si32 argc, rt_char *argv[])
 
 #include "rtzero.h"
 
+#if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
+
+#include <windows.h>
+
 #if RT_POINTER == 64
 #if RT_ADDRESS == 32
 
-#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000040000000)
-#define RT_ADDRESS_MAX      ((rt_byte *)0x0000000080000000)
+#define RT_ADDRESS_MIN      ((rt_byte *)0x0000000010000000)
+#define RT_ADDRESS_MAX      ((rt_byte *)RT_ADDRESS_TOP)
+
+/* hint step past foreign mappings */
+#define RT_ADDRESS_STEP     0x0000000001000000
 
 #else /* RT_ADDRESS == 64 */
 
@@ -1130,11 +1321,6 @@ rt_byte *s_ptr = RT_ADDRESS_MIN;
 
 #endif /* RT_POINTER */
 
-
-#if (defined RT_WIN32) || (defined RT_WIN64) /* Win32, MSVC -- Win64, GCC --- */
-
-#include <windows.h>
-
 /*
  * Get system time in milliseconds.
  */
@@ -1159,11 +1345,8 @@ rt_pntr sys_alloc(rt_size size)
 {
 #if (RT_POINTER - RT_ADDRESS) != 0
 
-    /* loop around RT_ADDRESS_MAX boundary */
-    if (s_ptr >= RT_ADDRESS_MAX - size)
-    {
-        s_ptr  = RT_ADDRESS_MIN;
-    }
+    rt_pntr ptr = RT_NULL;
+    rt_si32 wrap = 0;
 
     if (s_step == 0)
     {
@@ -1171,112 +1354,34 @@ rt_pntr sys_alloc(rt_size size)
         s_step = s_sys.dwAllocationGranularity;
     }
 
-    rt_pntr ptr = VirtualAlloc(s_ptr, size, MEM_COMMIT | MEM_RESERVE,
-                  PAGE_READWRITE);
-
-    /* advance with allocation granularity */
-    s_ptr = (rt_byte *)ptr + ((size + s_step - 1) / s_step) * s_step;
-
-#else /* (RT_POINTER - RT_ADDRESS) */
-
-    rt_pntr ptr = malloc(size);
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-#if RT_DEBUG >= 2
-
-    if (!l_mode)
-    RT_LOGI("ALLOC PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
-
-#endif /* RT_DEBUG */
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
-    {
-        throw rt_Exception("address exceeded allowed range in sys_alloc");
-    }
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-    if (ptr == RT_NULL)
+    /* in 64/32-bit hybrid mode addresses can't exceed RT_ADDRESS_TOP
+     * (rtbase.h), requested address skips past regions already in use
+     * and loops around RT_ADDRESS_MAX boundary at most once */
+    while (wrap < 2 && size < RT_ADDRESS_MAX - RT_ADDRESS_MIN)
     {
-        throw rt_Exception("alloc failed with NULL address in sys_alloc");
-    }
-
-    return ptr;
-}
-
-/*
- * Free memory from system heap.
- */
-rt_void sys_free(rt_pntr ptr, rt_size size)
-{
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    VirtualFree(ptr, 0, MEM_RELEASE);
-
-#else /* (RT_POINTER - RT_ADDRESS) */
-
-    free(ptr);
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
-#if RT_DEBUG >= 2
-
-    if (!l_mode)
-    RT_LOGI("FREED PTR = %016" PR_Z "X, size = %ld\n", (rt_full)ptr, size);
-
-#endif /* RT_DEBUG */
-}
-
-#elif (defined RT_LINUX) /* Linux, GCC -------------------------------------- */
-
-#include <sys/time.h>
-
-/*
- * Get system time in milliseconds.
- */
-rt_time get_time()
-{
-    timeval tm;
-    gettimeofday(&tm, NULL);
-    return (rt_time)(tm.tv_sec * 1000 + tm.tv_usec / 1000);
-}
-
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-#include <sys/mman.h>
-
-#ifndef MAP_ANONYMOUS
-#define MAP_ANONYMOUS MAP_ANON  /* workaround for macOS compilation */
-#endif /* macOS still cannot allocate with mmap within 32-bit range */
+        if (s_ptr >= RT_ADDRESS_MAX - size)
+        {
+            s_ptr  = RT_ADDRESS_MIN;
+            wrap++;
+            continue;
+        }
 
-#endif /* (RT_POINTER - RT_ADDRESS) */
+        ptr = VirtualAlloc(s_ptr, size, MEM_COMMIT | MEM_RESERVE,
+                           PAGE_READWRITE);
 
-/*
- * Allocate memory from system heap.
- * Not thread-safe due to common static ptr.
- */
-rt_pntr sys_alloc(rt_size size)
-{
-#if (RT_POINTER - RT_ADDRESS) != 0
+        if (ptr != RT_NULL)
+        {
+            break;
+        }
 
-    /* loop around RT_ADDRESS_MAX boundary */
-    /* in 64/32-bit hybrid mode addresses can't have sign bit
-     * as MIPS64 sign-extends all 32-bit mem-loads by default */
-    if (s_ptr >= RT_ADDRESS_MAX - size)
-    {
-        s_ptr  = RT_ADDRESS_MIN;
+        s_ptr += RT_ADDRESS_STEP;
     }
 
-    rt_pntr ptr = mmap(s_ptr, size, PROT_READ | PROT_WRITE,
-                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-
     /* advance with allocation granularity */
-    /* in case when page-size differs from default 4096 bytes
-     * mmap should round toward closest correct page boundary */
-    s_ptr = (rt_byte *)ptr + ((size + 4095) / 4096) * 4096;
+    if (ptr != RT_NULL)
+    {
+        s_ptr = (rt_byte *)ptr + ((size + s_step - 1) / s_step) * s_step;
+    }
 
 #else /* (RT_POINTER - RT_ADDRESS) */
 
@@ -1291,15 +1396,6 @@ rt_pntr sys_alloc(rt_size size)
 
 #endif /* RT_DEBUG */
 
-#if (RT_POINTER - RT_ADDRESS) != 0
-
-    if ((rt_byte *)ptr >= RT_ADDRESS_MAX - size)
-    {
-        throw rt_Exception("address exceeded allowed range in sys_alloc");
-    }
-
-#endif /* (RT_POINTER - RT_ADDRESS) */
-
     if (ptr == RT_NULL)
     {
         throw rt_Exception("alloc failed with NULL address in sys_alloc");
@@ -1315,7 +1411,7 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
 {
 #if (RT_POINTER - RT_ADDRESS) != 0
 
-    munmap(ptr, size);
+    VirtualFree(ptr, 0, MEM_RELEASE);
 
 #else /* (RT_POINTER - RT_ADDRESS) */
 
@@ -1331,6 +1427,11 @@ rt_void sys_free(rt_pntr ptr, rt_size size)
 #endif /* RT_DEBUG */
 }
 
+#elif (defined RT_LINUX) /* Linux, GCC -------------------------------------- */
+
+/* system time and heap are provided by posix.cpp
+ * along with the thread pool of the render farm */
+
 #endif /* ------------- OS specific ----------------------------------------- */
 
 /******************************************************************************/